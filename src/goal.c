@@ -22,6 +22,7 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -39,6 +40,7 @@
 #include "goal_internal.h"
 #include "iutil.h"
 #include "package_internal.h"
+#include "packageset_internal.h"
 #include "query_internal.h"
 #include "reldep_internal.h"
 #include "repo_internal.h"
@@ -51,6 +53,30 @@ struct _HyGoal {
     Queue staging;
     Solver *solv;
     Transaction *trans;
+    /* per HY_RESULT_*, the transaction's steps of that kind in the order of
+       the transaction, see goal_results() */
+    Queue *results;
+    /* times the solver ran for the last hy_goal_run*() */
+    int nsolves;
+};
+
+/* libsolv formats the solvables in its debug output through the pool's
+   temporary space, these are off while a batch solves in parallel */
+#define BATCH_QUIET_DEBUG \
+    (SOLV_DEBUG_STATS | SOLV_DEBUG_RULE_CREATION | SOLV_DEBUG_PROPAGATE | \
+     SOLV_DEBUG_ANALYZE | SOLV_DEBUG_UNSOLVABLE | SOLV_DEBUG_SOLUTIONS | \
+     SOLV_DEBUG_POLICY | SOLV_DEBUG_RESULT | SOLV_DEBUG_JOB | \
+     SOLV_DEBUG_SOLVER | SOLV_DEBUG_TRANSACTION | SOLV_DEBUG_WATCHES)
+
+/* goals solved by a pool of threads, see hy_goal_run_batch() */
+struct _GoalBatch {
+    HyGoal *goals;
+    Queue **jobs;
+    int ngoals;
+    int flags;
+    pthread_mutex_t lock;
+    int next;			/* the next goal to solve */
+    int nfailed;
 };
 
 struct _SolutionCallback {
@@ -160,6 +186,39 @@ sort_packages(const void *ap, const void *bp, void *s_cb)
     return pool_evrcmp(pool, sa->evr, sb->evr, EVRCMP_COMPARE);
 }
 
+/* push jobs erasing all but 'installonly_limit' packages of each name in
+   'q', with 'keep' also jobs installing those. returns 1 if any name was
+   over the limit. */
+static int
+limit_installonly_queue(HySack sack, Queue *q, Queue *job, int keep)
+{
+    Pool *pool = sack_pool(sack);
+    int overlimit = 0;
+
+    if (q->count <= sack->installonly_limit)
+	return 0;
+
+    struct InstallonliesSortCallback s_cb = {pool, sack_running_kernel(sack)};
+    qsort_r(q->elements, q->count, sizeof(q->elements[0]), sort_packages, &s_cb);
+    Queue same_names;
+    queue_init(&same_names);
+    while (q->count > 0) {
+	same_name_subqueue(pool, q, &same_names);
+	if (same_names.count <= sack->installonly_limit)
+	    continue;
+	overlimit = 1;
+	for (int j = 0; j < same_names.count; ++j) {
+	    Id id  = same_names.elements[j];
+	    if (j >= sack->installonly_limit)
+		queue_push2(job, SOLVER_ERASE | SOLVER_SOLVABLE, id);
+	    else if (keep)
+		queue_push2(job, SOLVER_INSTALL | SOLVER_SOLVABLE, id);
+	}
+    }
+    queue_free(&same_names);
+    return overlimit;
+}
+
 static int
 limit_installonly_packages(HyGoal goal, Solver *solv, Queue *job)
 {
@@ -179,32 +238,200 @@ limit_installonly_packages(HyGoal goal, Solver *solv, Queue *job)
 	FOR_PKG_PROVIDES(p, pp, onlies->elements[i])
 	    if (solver_get_decisionlevel(solv, p) > 0)
 		queue_push(&q, p);
-	if (q.count <= sack->installonly_limit) {
-	    queue_free(&q);
+	reresolve |= limit_installonly_queue(sack, &q, job, 1);
+	queue_free(&q);
+    }
+    return reresolve;
+}
+
+/* the packages 'job' installs or updates, 'all' is set for updating or
+   distupgrading everything */
+static void
+job_selected(Pool *pool, Queue *job, Map *selected, int *all)
+{
+    Queue pkgs;
+
+    queue_init(&pkgs);
+    *all = 0;
+    for (int i = 0; i < job->count; i += 2) {
+	Id how = job->elements[i];
+	Id type = how & SOLVER_JOBMASK;
+
+	if (type != SOLVER_INSTALL && type != SOLVER_UPDATE &&
+	    type != SOLVER_DISTUPGRADE)
+	    continue;
+	if ((how & SOLVER_SELECTMASK) == SOLVER_SOLVABLE_ALL) {
+	    *all |= type != SOLVER_INSTALL;
 	    continue;
 	}
+	pool_job2solvables(pool, &pkgs, how, job->elements[i + 1]);
+	for (int j = 0; j < pkgs.count; ++j)
+	    MAPSET(selected, pkgs.elements[j]);
+    }
+    queue_free(&pkgs);
+}
 
-	struct InstallonliesSortCallback s_cb = {pool, sack_running_kernel(sack)};
-	qsort_r(q.elements, q.count, sizeof(q.elements[0]), sort_packages, &s_cb);
-	Queue same_names;
-	queue_init(&same_names);
-	while (q.count > 0) {
-	    same_name_subqueue(pool, &q, &same_names);
-	    if (same_names.count <= sack->installonly_limit)
+/* whether 'p' is newer than all the installed packages of its name in 'q'
+   and one of them has its arch. other arches are left for the solver to
+   pick, or not. */
+static int
+newer_than_installed(Pool *pool, Id p, Queue *q)
+{
+    Solvable *s = pool_id2solvable(pool, p);
+    int same_arch = 0;
+
+    for (int i = 0; i < q->count; ++i) {
+	Solvable *si = pool_id2solvable(pool, q->elements[i]);
+	if (si->repo != pool->installed || si->name != s->name)
+	    continue;
+	if (pool_evrcmp(pool, s->evr, si->evr, EVRCMP_COMPARE) <= 0)
+	    return 0;
+	if (si->arch == s->arch)
+	    same_arch = 1;
+    }
+    return same_arch;
+}
+
+/* let the solver erase the installed packages needing the ones erased by
+   the jobs from 'from' on, the way uninstalling is allowed when solving
+   again after limit_installonly_packages() */
+static void
+allow_uninstall_dependents(HySack sack, Queue *job, int from)
+{
+    Pool *pool = sack_pool(sack);
+    struct _RevdepIndex *idx;
+    Queue todo;
+    Map seen;
+
+    if (!pool->installed)
+	return;
+    sack_make_revdep_index_ready(sack);
+    idx = sack->revdep_index;
+    queue_init(&todo);
+    map_init(&seen, pool->nsolvables);
+    for (int i = from; i < job->count; i += 2)
+	if ((job->elements[i] & SOLVER_JOBMASK) == SOLVER_ERASE) {
+	    queue_push(&todo, job->elements[i + 1]);
+	    MAPSET(&seen, job->elements[i + 1]);
+	}
+    while (todo.count) {
+	Id e = queue_pop(&todo);
+	Solvable *se = pool_id2solvable(pool, e);
+	if (!se->provides)
+	    continue;
+	for (Id *dp = se->repo->idarraydata + se->provides; *dp; ++dp) {
+	    Id name = *dp;
+	    while (ISRELDEP(name))
+		name = GETRELDEP(pool, name)->name;
+	    if (name >= idx->nheads)
 		continue;
-	    reresolve = 1;
-	    for (int j = 0; j < same_names.count; ++j) {
-		Id id  = same_names.elements[j];
-		Id action = SOLVER_ERASE;
-		if (j < sack->installonly_limit)
-		    action = SOLVER_INSTALL;
-		queue_push2(job, action | SOLVER_SOLVABLE, id);
+	    for (int k = idx->heads[name]; k >= 0; k = idx->entries[k].next) {
+		Id p = idx->entries[k].solvable;
+		Solvable *s = pool_id2solvable(pool, p);
+		if (!(idx->entries[k].keys & REVDEP_REQUIRES) ||
+		    s->repo != pool->installed || MAPTST(&seen, p) ||
+		    !can_depend_on(pool, s, e))
+		    continue;
+		MAPSET(&seen, p);
+		queue_push2(job, SOLVER_ALLOWUNINSTALL | SOLVER_SOLVABLE, p);
+		queue_push(&todo, p);
 	    }
 	}
-	queue_free(&same_names);
+    }
+    map_free(&seen);
+    queue_free(&todo);
+}
+
+/* enforce the installonly limit up front: push the jobs
+   limit_installonly_packages() would once the solver installed the newest
+   selected version of every installonly name */
+static void
+plan_installonly_limit(HyGoal goal, Queue *job)
+{
+    HySack sack = goal->sack;
+    Pool *pool = sack_pool(sack);
+    Queue *onlies = &sack->installonly;
+    int count = job->count;
+    Map selected;
+    int all;
+
+    map_init(&selected, pool->nsolvables);
+    job_selected(pool, job, &selected, &all);
+    for (int i = 0; i < onlies->count; ++i) {
+	Id p, pp;
+	Queue q, best;
+	queue_init(&q);
+	queue_init(&best);
+
+	FOR_PKG_PROVIDES(p, pp, onlies->elements[i]) {
+	    Solvable *s = pool_id2solvable(pool, p);
+	    if (s->repo == pool->installed) {
+		queue_push(&q, p);
+		continue;
+	    }
+	    if (!all && !MAPTST(&selected, p))
+		continue;
+	    if (pool->considered && !MAPTST(pool->considered, p))
+		continue;
+	    // the newest of each name and arch
+	    int j;
+	    for (j = 0; j < best.count; ++j) {
+		Solvable *sb = pool_id2solvable(pool, best.elements[j]);
+		if (sb->name == s->name && sb->arch == s->arch) {
+		    if (pool_evrcmp(pool, s->evr, sb->evr, EVRCMP_COMPARE) > 0)
+			best.elements[j] = p;
+		    break;
+		}
+	    }
+	    if (j == best.count)
+		queue_push(&best, p);
+	}
+	for (int j = 0; j < best.count; ++j)
+	    if (newer_than_installed(pool, best.elements[j], &q))
+		queue_push(&q, best.elements[j]);
+	limit_installonly_queue(sack, &q, job, 1);
+	queue_free(&best);
 	queue_free(&q);
     }
-    return reresolve;
+    map_free(&selected);
+    allow_uninstall_dependents(sack, job, count);
+}
+
+static int
+run_solver(HyGoal goal, Solver *solv, Queue *job)
+{
+    goal->nsolves++;
+    return solver_solve(solv, job);
+}
+
+/* solve with the installonly limit planned ahead. returns 0 if the plan
+   held and the solution stands, otherwise 'job' is restored for solving
+   the usual way. */
+static int
+solve_planned(HyGoal goal, Solver *solv, Queue *job)
+{
+    int count = job->count;
+    int held = 0;
+
+    plan_installonly_limit(goal, job);
+    if (job->count > count && !run_solver(goal, solv, job))
+	held = !limit_installonly_packages(goal, solv, job);
+    if (!held)
+	queue_truncate(job, count);
+    return held ? 0 : 1;
+}
+
+static void
+free_transaction(HyGoal goal)
+{
+    if (goal->trans)
+	transaction_free(goal->trans);
+    goal->trans = NULL;
+    if (goal->results) {
+	for (int i = 0; i < _HY_RESULT_NUM; ++i)
+	    queue_free(goal->results + i);
+	goal->results = solv_free(goal->results);
+    }
 }
 
 static int
@@ -217,23 +444,32 @@ internal_solver_callback(Solver *solv, void *data)
     assert(goal->trans == NULL);
     goal->trans = solver_create_transaction(solv);
     int ret = s_cb->callback(goal, s_cb->callback_data);
-    transaction_free(goal->trans);
-    goal->trans = NULL;
+    free_transaction(goal);
     return ret;
 }
 
+static void
+release_solver(HyGoal goal)
+{
+    if (goal->solv)
+	sack_give_solver(goal->sack, goal->solv);
+    goal->solv = NULL;
+}
+
 static Solver *
 init_solver(HyGoal goal, int flags)
 {
-    Pool *pool = sack_pool(goal->sack);
-    Solver *solv = solver_create(pool);
-
-    if (goal->solv)
-	solver_free(goal->solv);
+    release_solver(goal);
+    Solver *solv = sack_take_solver(goal->sack);
+    if (solv == NULL)
+	solv = solver_create(sack_pool(goal->sack));
     goal->solv = solv;
 
-    if (flags & HY_ALLOW_UNINSTALL)
-	solver_set_flag(solv, SOLVER_FLAG_ALLOW_UNINSTALL, 1);
+    /* a cached solver still has the flags of its last goal */
+    solver_set_flag(solv, SOLVER_FLAG_ALLOW_UNINSTALL,
+		    (flags & HY_ALLOW_UNINSTALL) != 0);
+    solv->solution_callback = NULL;
+    solv->solution_callback_data = NULL;
     /* no vendor locking */
     solver_set_flag(solv, SOLVER_FLAG_ALLOW_VENDORCHANGE, 1);
     /* don't erase packages that are no longer in repo during distupgrade */
@@ -255,10 +491,8 @@ solve(HyGoal goal, Queue *job, int flags, hy_solution_callback user_cb,
 
     repo_internalize_all_trigger(sack_pool(sack));
     sack_make_provides_ready(sack);
-    if (goal->trans) {
-	transaction_free(goal->trans);
-	goal->trans = NULL;
-    }
+    free_transaction(goal);
+    goal->nsolves = 0;
 
     Solver *solv = init_solver(goal, flags);
     if (user_cb) {
@@ -267,15 +501,20 @@ solve(HyGoal goal, Queue *job, int flags, hy_solution_callback user_cb,
 	solv->solution_callback_data = &cb_tuple;
     }
 
-    if (solver_solve(solv, job))
-	return 1;
     // either allow solutions callback or installonlies, both at the same time
     // are not supported
+    if (!user_cb && (flags & HY_PLAN_INSTALLONLY) && sack->installonly_limit &&
+	solve_planned(goal, solv, job) == 0) {
+	goal->trans = solver_create_transaction(solv);
+	return 0;
+    }
+    if (run_solver(goal, solv, job))
+	return 1;
     if (!user_cb && limit_installonly_packages(goal, solv, job)) {
 	// allow erasing non-installonly packages that depend on a kernel about
 	// to be erased
 	solver_set_flag(solv, SOLVER_FLAG_ALLOW_UNINSTALL, 1);
-	if (solver_solve(solv, job))
+	if (run_solver(goal, solv, job))
 	    return 1;
     }
     goal->trans = solver_create_transaction(solv);
@@ -306,6 +545,18 @@ construct_job(HyGoal goal, int flags)
     return job;
 }
 
+/* libsolv computes the providers of a dependency the first time it is asked
+   for them, this asks for all the job's ones at once */
+static void
+job_whatprovides(Pool *pool, Queue *job)
+{
+    for (int i = 0; i < job->count; i += 2) {
+	Id select = job->elements[i] & SOLVER_SELECTMASK;
+	if (select == SOLVER_SOLVABLE_NAME || select == SOLVER_SOLVABLE_PROVIDES)
+	    pool_whatprovides(pool, job->elements[i + 1]);
+    }
+}
+
 static void
 free_job(Queue *job)
 {
@@ -313,12 +564,12 @@ free_job(Queue *job)
     solv_free(job);
 }
 
-static HyPackageList
-list_results(HyGoal goal, Id type_filter1, Id type_filter2)
+/* sort all the steps of the transaction into the HY_RESULT_* kinds at once,
+   the result is kept until the transaction goes */
+static Queue *
+goal_results(HyGoal goal)
 {
-    Queue transpkgs;
     Transaction *trans = goal->trans;
-    HyPackageList plist;
 
     if (!trans) {
 	if (!goal->solv)
@@ -327,29 +578,65 @@ list_results(HyGoal goal, Id type_filter1, Id type_filter2)
 	    hy_errno = HY_E_NO_SOLUTION;
 	return NULL;
     }
-    queue_init(&transpkgs);
-    plist = hy_packagelist_create();
+    if (goal->results)
+	return goal->results;
+
+    Pool *pool = trans->pool;
+    Queue *results = solv_calloc(_HY_RESULT_NUM, sizeof(Queue));
     const int common_mode = SOLVER_TRANSACTION_SHOW_OBSOLETES |
 	SOLVER_TRANSACTION_CHANGE_IS_REINSTALL;
 
+    for (int i = 0; i < _HY_RESULT_NUM; ++i)
+	queue_init(results + i);
     for (int i = 0; i < trans->steps.count; ++i) {
 	Id p = trans->steps.elements[i];
-	Id type;
+	int which = -1;
 
-	switch (type_filter1) {
-	case SOLVER_TRANSACTION_OBSOLETED:
-	    type =  transaction_type(trans, p, common_mode);
+	switch (transaction_type(trans, p, common_mode |
+				 SOLVER_TRANSACTION_SHOW_ACTIVE |
+				 SOLVER_TRANSACTION_SHOW_ALL)) {
+	case SOLVER_TRANSACTION_ERASE:
+	    which = HY_RESULT_ERASURES;
+	    break;
+	case SOLVER_TRANSACTION_INSTALL:
+	case SOLVER_TRANSACTION_OBSOLETES:
+	    which = HY_RESULT_INSTALLS;
 	    break;
-	default:
-	    type  = transaction_type(trans, p, common_mode |
-				     SOLVER_TRANSACTION_SHOW_ACTIVE|
-				     SOLVER_TRANSACTION_SHOW_ALL);
+	case SOLVER_TRANSACTION_REINSTALL:
+	    which = HY_RESULT_REINSTALLS;
+	    break;
+	case SOLVER_TRANSACTION_UPGRADE:
+	    which = HY_RESULT_UPGRADES;
+	    break;
+	case SOLVER_TRANSACTION_DOWNGRADE:
+	    which = HY_RESULT_DOWNGRADES;
 	    break;
 	}
-
-	if (type == type_filter1 || (type_filter2 && type == type_filter2))
-	    hy_packagelist_push(plist, package_create(goal->sack, p));
+	if (which >= 0)
+	    queue_push(results + which, p);
+	// only installed packages get obsoleted
+	if (pool->installed &&
+	    pool_id2solvable(pool, p)->repo == pool->installed &&
+	    transaction_type(trans, p, common_mode) ==
+	    SOLVER_TRANSACTION_OBSOLETED)
+	    queue_push(results + HY_RESULT_OBSOLETED, p);
     }
+    goal->results = results;
+    return results;
+}
+
+static HyPackageList
+list_results(HyGoal goal, int which)
+{
+    Queue *results = goal_results(goal);
+
+    if (!results)
+	return NULL;
+
+    HyPackageList plist = hy_packagelist_create();
+    for (int i = 0; i < results[which].count; ++i)
+	hy_packagelist_push(plist, package_create(goal->sack,
+						  results[which].elements[i]));
     return plist;
 }
 
@@ -539,7 +826,7 @@ int
 sltr2job(const HySelector sltr, Queue *job, int solver_action)
 {
     HySack sack = selector_sack(sltr);
-    int ret = 0;
+    int ret = 0, frozen = 0;
     Queue job_sltr;
     int any_opt_filter = sltr->f_arch || sltr->f_evr || sltr->f_reponame;
     int any_req_filter = sltr->f_name || sltr->f_provides || sltr->f_file;
@@ -554,6 +841,11 @@ sltr2job(const HySelector sltr, Queue *job, int solver_action)
     }
 
     sack_make_provides_ready(sack);
+    /* new strings and relations grow the pool under the queries of a frozen
+       sack */
+    frozen = sack_frozen(sack);
+    if (frozen)
+	sack_frozen_lock(sack, 1);
     ret = filter_name2job(sack, sltr->f_name, &job_sltr);
     if (ret)
 	goto finish;
@@ -572,6 +864,8 @@ sltr2job(const HySelector sltr, Queue *job, int solver_action)
     ret = filter_reponame2job(sack, sltr->f_reponame, &job_sltr);
     if (ret)
         goto finish;
+    if (frozen)
+	job_whatprovides(sack_pool(sack), &job_sltr);
 
     for (int i = 0; i < job_sltr.count; i += 2)
  	queue_push2(job,
@@ -579,12 +873,20 @@ sltr2job(const HySelector sltr, Queue *job, int solver_action)
  		    job_sltr.elements[i + 1]);
 
  finish:
+    if (frozen)
+	sack_frozen_unlock(sack);
     if (ret)
  	hy_errno = ret;
     queue_free(&job_sltr);
     return ret;
 }
 
+int
+goal_nsolves(HyGoal goal)
+{
+    return goal->nsolves;
+}
+
 // public functions
 
 HyGoal
@@ -599,10 +901,8 @@ hy_goal_create(HySack sack)
 void
 hy_goal_free(HyGoal goal)
 {
-    if (goal->trans)
-	transaction_free(goal->trans);
-    if (goal->solv)
-	solver_free(goal->solv);
+    free_transaction(goal);
+    release_solver(goal);
     queue_free(&goal->staging);
     solv_free(goal);
 }
@@ -791,6 +1091,120 @@ hy_goal_run_all_flags(HyGoal goal, hy_solution_callback cb, void *cb_data,
     return ret;
 }
 
+static void *
+batch_worker(void *arg)
+{
+    struct _GoalBatch *batch = arg;
+
+    while (1) {
+	pthread_mutex_lock(&batch->lock);
+	int i = batch->next++;
+	pthread_mutex_unlock(&batch->lock);
+	if (i >= batch->ngoals)
+	    return NULL;
+	HyGoal goal = batch->goals[i];
+	sack_frozen_lock(goal->sack, 0);
+	int ret = solve(goal, batch->jobs[i], batch->flags, NULL, NULL);
+	sack_frozen_unlock(goal->sack);
+	if (ret) {
+	    pthread_mutex_lock(&batch->lock);
+	    batch->nfailed++;
+	    pthread_mutex_unlock(&batch->lock);
+	}
+    }
+}
+
+/* switch the BATCH_QUIET_DEBUG output off for a parallel batch, 'quiet' 0
+   switches it back on once the last batch running at the time is done. the
+   exclusive frozen lock keeps every other solve and query out meanwhile. */
+static void
+batch_quiet(HySack sack, int quiet)
+{
+    Pool *pool = sack_pool(sack);
+
+    sack_frozen_lock(sack, 1);
+    if (quiet) {
+	if (sack->quiet_batches++ == 0) {
+	    sack->batch_debugmask = pool->debugmask;
+	    pool_setdebugmask(pool, pool->debugmask & ~BATCH_QUIET_DEBUG);
+	}
+    } else if (--sack->quiet_batches == 0)
+	pool_setdebugmask(pool, sack->batch_debugmask);
+    sack_frozen_unlock(sack);
+}
+
+/**
+ * Run all the 'goals', as hy_goal_run_flags() would one by one, using up to
+ * 'nthreads' threads. Each goal's problems and results are then available as
+ * after hy_goal_run_flags().
+ *
+ * The goals must all be on the same sack. Unless the sack is frozen, see
+ * hy_sack_freeze(), they are solved one after the other in the calling
+ * thread. On a frozen sack the jobs of all the goals are first built and the
+ * providers of their dependencies computed, the selectors can have added new
+ * ones. This holds the sack's exclusive lock, queries in other threads wait
+ * for it briefly. While goals are solved in parallel libsolv's debug output
+ * about them is not logged, its errors and warnings still are.
+ *
+ * @returns	the number of goals that could not be solved, 0 if all were.
+ */
+int
+hy_goal_run_batch(HyGoal *goals, int ngoals, int flags, int nthreads)
+{
+    if (ngoals == 0)
+	return 0;
+
+    HySack sack = goals[0]->sack;
+    struct _GoalBatch batch = {goals, NULL, ngoals, flags};
+    int frozen = sack_frozen(sack);
+
+    /* the parallel solves must only read the providers of the jobs'
+       dependencies, so these are all computed up front */
+    batch.jobs = solv_calloc(ngoals, sizeof(Queue *));
+    if (frozen)
+	sack_frozen_lock(sack, 1);
+    for (int i = 0; i < ngoals; ++i) {
+	assert(goals[i]->sack == sack);
+	batch.jobs[i] = construct_job(goals[i], flags);
+	if (frozen)
+	    job_whatprovides(sack_pool(sack), batch.jobs[i]);
+    }
+    if (frozen)
+	sack_frozen_unlock(sack);
+    if (nthreads > ngoals)
+	nthreads = ngoals;
+    if (!frozen)
+	nthreads = 1;
+
+    if (nthreads <= 1) {
+	for (int i = 0; i < ngoals; ++i)
+	    batch.nfailed += solve(goals[i], batch.jobs[i], flags, NULL, NULL);
+    } else {
+	/* the running kernel is only looked up once */
+	pthread_t threads[nthreads - 1];
+	int started = 0;
+
+	if (sack->installonly_limit)
+	    sack_running_kernel(sack);
+	batch_quiet(sack, 1);
+	pthread_mutex_init(&batch.lock, NULL);
+	/* the calling thread does its share too */
+	while (started < nthreads - 1 &&
+	       !pthread_create(threads + started, NULL, batch_worker, &batch))
+	    ++started;
+	batch_worker(&batch);
+	for (int i = 0; i < started; ++i)
+	    pthread_join(threads[i], NULL);
+	pthread_mutex_destroy(&batch.lock);
+	batch_quiet(sack, 0);
+    }
+
+    for (int i = 0; i < ngoals; ++i)
+	free_job(batch.jobs[i]);
+    solv_free(batch.jobs);
+    return batch.nfailed;
+}
+
 int
 hy_goal_count_problems(HyGoal goal)
 {
@@ -861,26 +1275,25 @@ hy_goal_write_debugdata(HyGoal goal, const char *dir)
 HyPackageList
 hy_goal_list_erasures(HyGoal goal)
 {
-    return list_results(goal, SOLVER_TRANSACTION_ERASE, 0);
+    return list_results(goal, HY_RESULT_ERASURES);
 }
 
 HyPackageList
 hy_goal_list_installs(HyGoal goal)
 {
-    return list_results(goal, SOLVER_TRANSACTION_INSTALL,
-			SOLVER_TRANSACTION_OBSOLETES);
+    return list_results(goal, HY_RESULT_INSTALLS);
 }
 
 HyPackageList
 hy_goal_list_obsoleted(HyGoal goal)
 {
-    return list_results(goal, SOLVER_TRANSACTION_OBSOLETED, 0);
+    return list_results(goal, HY_RESULT_OBSOLETED);
 }
 
 HyPackageList
 hy_goal_list_reinstalls(HyGoal goal)
 {
-    return list_results(goal, SOLVER_TRANSACTION_REINSTALL, 0);
+    return list_results(goal, HY_RESULT_REINSTALLS);
 }
 
 HyPackageList
@@ -900,13 +1313,32 @@ hy_goal_list_unneeded(HyGoal goal)
 HyPackageList
 hy_goal_list_upgrades(HyGoal goal)
 {
-    return list_results(goal, SOLVER_TRANSACTION_UPGRADE, 0);
+    return list_results(goal, HY_RESULT_UPGRADES);
 }
 
 HyPackageList
 hy_goal_list_downgrades(HyGoal goal)
 {
-    return list_results(goal, SOLVER_TRANSACTION_DOWNGRADE, 0);
+    return list_results(goal, HY_RESULT_DOWNGRADES);
+}
+
+/**
+ * The packages of one kind of result, like the matching hy_goal_list_*()
+ * function but as a set. The transaction is classified once for all the
+ * kinds, the set does not hold a package handle per package.
+ *
+ * @returns	NULL with hy_errno set if the goal has no solution.
+ */
+HyPackageSet
+hy_goal_get_result_set(HyGoal goal, int which)
+{
+    assert(which >= 0 && which < _HY_RESULT_NUM);
+    Queue *results = goal_results(goal);
+
+    if (!results)
+	return NULL;
+    return packageset_from_ids(goal->sack, results[which].elements,
+			       results[which].count);
 }
 
 HyPackageList
@@ -35,7 +35,20 @@ enum _hy_goal_op_flags {
 
 enum _hy_goal_run_flags {
     HY_ALLOW_UNINSTALL = 1 << 0,
-    HY_FORCE_BEST = 1 << 1
+    HY_FORCE_BEST = 1 << 1,
+    /* erase the installonly packages over the limit in the first solve */
+    HY_PLAN_INSTALLONLY = 1 << 2
+};
+
+/* the kinds of results, see hy_goal_get_result_set() */
+enum _hy_goal_result_e {
+    HY_RESULT_ERASURES,
+    HY_RESULT_INSTALLS,
+    HY_RESULT_OBSOLETED,
+    HY_RESULT_REINSTALLS,
+    HY_RESULT_UPGRADES,
+    HY_RESULT_DOWNGRADES,
+    _HY_RESULT_NUM
 };
 
 #define HY_REASON_DEP 1
@@ -79,6 +92,7 @@ int hy_goal_run_flags(HyGoal goal, int flags);
 int hy_goal_run_all(HyGoal goal, hy_solution_callback cb, void *cb_data);
 int hy_goal_run_all_flags(HyGoal goal, hy_solution_callback cb, void *cb_data,
 			  int flags);
+int hy_goal_run_batch(HyGoal *goals, int ngoals, int flags, int nthreads);
 
 /* problems */
 int hy_goal_count_problems(HyGoal goal);
@@ -95,6 +109,7 @@ HyPackageList hy_goal_list_unneeded(HyGoal goal);
 HyPackageList hy_goal_list_upgrades(HyGoal goal);
 HyPackageList hy_goal_list_downgrades(HyGoal goal);
 HyPackageList hy_goal_list_obsoleted_by_package(HyGoal goal, HyPackage pkg);
+HyPackageSet hy_goal_get_result_set(HyGoal goal, int which);
 int hy_goal_get_reason(HyGoal goal, HyPackage pkg);
 
 #ifdef __cplusplus
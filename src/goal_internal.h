@@ -28,5 +28,6 @@
 #include "goal.h"
 
 int sltr2job(const HySelector sltr, Queue *job, int solver_action);
+int goal_nsolves(HyGoal goal);
 
 #endif // HY_GOAL_INTERNAL_H
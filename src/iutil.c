@@ -441,7 +441,7 @@ running_kernel(HySack sack)
     hy_query_free(q);
 
     if (kernel_id >= 0)
-	HY_LOG_INFO("running_kernel(): %s.", id2nevra(pool, kernel_id));
+	HY_LOG_INFO("running_kernel(): %s.", id2nevra(sack, kernel_id));
     else
 	HY_LOG_INFO("running_kernel(): running kernel not matched to a package.");
     return kernel_id;
@@ -696,10 +696,9 @@ dump_map(Pool *pool, Map *m)
 }
 
 const char *
-id2nevra(Pool *pool, Id id)
+id2nevra(HySack sack, Id id)
 {
-    Solvable *s = pool_id2solvable(pool, id);
-    return pool_solvable2str(pool, s);
+    return sack_get_nevra(sack, id);
 }
 
 int
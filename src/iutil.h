@@ -102,7 +102,7 @@ int dump_jobqueue(Pool *pool, Queue *job);
 int dump_nullt_array(const char **a);
 int dump_solvables_queue(Pool *pool, Queue *q);
 int dump_map(Pool *pool, Map *m);
-const char *id2nevra(Pool *pool, Id id);
+const char *id2nevra(HySack sack, Id id);
 
 /* loop over all package providers of d */
 #define FOR_PKG_PROVIDES(v, vp, d)                                      \
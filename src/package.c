@@ -92,6 +92,31 @@ package_create(HySack sack, Id id)
     return pkg;
 }
 
+/**
+ * Create 'count' packages at once, in a single allocation.
+ *
+ * Returns the first of them, the rest follow in the array. Each is freed
+ * with hy_package_free() as usual, the memory goes when the last one does.
+ */
+HyPackage
+packages_create(HySack sack, const Id *ids, int count)
+{
+    struct _PackageArena *arena;
+
+    if (count == 0)
+	return NULL;
+    arena = solv_calloc(1, sizeof(*arena) + count * sizeof(struct _HyPackage));
+    arena->nrefs = count;
+    for (int i = 0; i < count; ++i) {
+	HyPackage pkg = arena->packages + i;
+	pkg->nrefs = 1;
+	pkg->sack = sack;
+	pkg->id = ids[i];
+	pkg->arena = arena;
+    }
+    return arena->packages;
+}
+
 HyPackage
 package_from_solvable(HySack sack, Solvable *s)
 {
@@ -116,7 +141,10 @@ hy_package_free(HyPackage pkg)
 	return;
     if (pkg->destroy_func)
 	pkg->destroy_func(pkg->userdata);
-    solv_free(pkg);
+    if (pkg->arena == NULL)
+	solv_free(pkg);
+    else if (--pkg->arena->nrefs == 0)
+	solv_free(pkg->arena);
 }
 
 HyPackage
@@ -202,8 +230,18 @@ hy_package_get_baseurl(HyPackage pkg)
 char *
 hy_package_get_nevra(HyPackage pkg)
 {
-    Solvable *s = get_solvable(pkg);
-    return solv_strdup(pool_solvable2str(package_pool(pkg), s));
+    return solv_strdup(hy_package_get_nevra_cached(pkg));
+}
+
+/**
+ * Like hy_package_get_nevra() but without allocating: the string is built
+ * once per package and kept by the sack. It is valid until a repo is freed
+ * or the sack is.
+ */
+const char *
+hy_package_get_nevra_cached(HyPackage pkg)
+{
+    return sack_get_nevra(pkg->sack, pkg->id);
 }
 
 char *
@@ -34,6 +34,13 @@ struct _HyPackage {
     HySack sack;
     void *userdata;
     HyUserdataDestroy destroy_func;
+    struct _PackageArena *arena; /* NULL if allocated on its own */
+};
+
+/* packages allocated in one block, see packages_create() */
+struct _PackageArena {
+    int nrefs;			/* packages not freed yet */
+    struct _HyPackage packages[];
 };
 
 struct _HyPackageDelta {
@@ -46,6 +53,7 @@ struct _HyPackageDelta {
 
 HyPackage package_clone(HyPackage pkg);
 HyPackage package_create(HySack sack, Id id);
+HyPackage packages_create(HySack sack, const Id *ids, int count);
 static inline Id package_id(HyPackage pkg) { return pkg->id; }
 Pool *package_pool(HyPackage pkg);
 static inline HySack package_sack(HyPackage pkg) { return pkg->sack; }
@@ -27,7 +27,7 @@
 #include <solv/util.h>
 
 // hawkey
-#include "packagelist.h"
+#include "packagelist_internal.h"
 #include "package_internal.h"
 #include "sack_internal.h"
 
@@ -56,6 +56,21 @@ hy_packagelist_free(HyPackageList plist)
     solv_free(plist);
 }
 
+/* a list of the packages 'ids', created in one block by packages_create() */
+HyPackageList
+packagelist_create_packed(HySack sack, const Id *ids, int count)
+{
+    HyPackageList plist = hy_packagelist_create();
+    HyPackage packages = packages_create(sack, ids, count);
+
+    plist->elements = solv_extend_resize(NULL, count, sizeof(HyPackage),
+					 BLOCK_SIZE);
+    for (int i = 0; i < count; ++i)
+	plist->elements[i] = packages + i;
+    plist->count = count;
+    return plist;
+}
+
 int
 hy_packagelist_count(HyPackageList plist)
 {
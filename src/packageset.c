@@ -19,6 +19,8 @@
  */
 
 #include <assert.h>
+#include <stdint.h>
+#include <string.h>
 
 // libsolv
 #include <solv/bitmap.h>
@@ -29,67 +31,162 @@
 #include "packageset_internal.h"
 #include "sack_internal.h"
 
+/* a set holding few packages compared to the size of the pool keeps their
+   sorted Ids ('sparse'), a bitmap over the whole pool ('dense') otherwise.
+   the Ids take 32 bits per package, the bitmap one bit per solvable. */
 struct _HyPackageSet {
     HySack sack;
-    Map map;
+    int sparse;
+    Id *ids;
+    int nids;
+    Map map;			/* only initialized if not sparse */
 };
 
-// see http://graphics.stanford.edu/~seander/bithacks.html#CountBitsSetTable
-static const unsigned char _BitCountLookup[256] =
+#define IDS_BLOCK 31
+
+static int
+sparse_limit(HyPackageSet pset)
 {
-#   define B2(n) n,     n+1,     n+1,     n+2
-#   define B4(n) B2(n), B2(n+1), B2(n+1), B2(n+2)
-#   define B6(n) B4(n), B4(n+1), B4(n+1), B4(n+2)
-    B6(0), B6(1), B6(1), B6(2)
-};
+    return sack_pool(pset->sack)->nsolvables / 32;
+}
 
-static Id
-map_index2id(Map *map, unsigned index, Id previous)
+/* index of 'id' in the sparse ids or where it would be inserted */
+static int
+ids_find(HyPackageSet pset, Id id)
 {
-    unsigned char *ti = map->map;
-    unsigned char *end = ti + map->size;
-    int enabled;
-    Id id;
+    int lo = 0, hi = pset->nids;
+
+    while (lo < hi) {
+	int mid = (lo + hi) / 2;
+	if (pset->ids[mid] < id)
+	    lo = mid + 1;
+	else
+	    hi = mid;
+    }
+    return lo;
+}
+
+/* initialize 'm' to the sparse ids */
+static void
+ids_to_map(HyPackageSet pset, Map *m)
+{
+    int size = sack_pool(pset->sack)->nsolvables;
+
+    if (pset->nids && pset->ids[pset->nids - 1] >= size)
+	size = pset->ids[pset->nids - 1] + 1;
+    map_init(m, size);
+    for (int i = 0; i < pset->nids; ++i)
+	MAPSET(m, pset->ids[i]);
+}
+
+static void
+make_dense(HyPackageSet pset)
+{
+    if (!pset->sparse)
+	return;
+    ids_to_map(pset, &pset->map);
+    pset->ids = solv_free(pset->ids);
+    pset->nids = 0;
+    pset->sparse = 0;
+}
+
+static void
+make_sparse(HyPackageSet pset, unsigned count)
+{
+    Map *m = &pset->map;
+
+    pset->ids = solv_extend_resize(NULL, count, sizeof(Id), IDS_BLOCK);
+    pset->nids = 0;
+    for (Id id = map_next(m, 0); id >= 0; id = map_next(m, id + 1))
+	pset->ids[pset->nids++] = id;
+    map_free(m);
+    pset->sparse = 1;
+}
+
+/* switch to the representation that suits the count of packages, a dense
+   set has to get well below the limit to avoid flipping back and forth */
+static void
+choose_representation(HyPackageSet pset)
+{
+    if (pset->sparse) {
+	if (pset->nids > sparse_limit(pset))
+	    make_dense(pset);
+	return;
+    }
+    unsigned count = map_count(&pset->map);
+    if (count <= sparse_limit(pset) / 2)
+	make_sparse(pset, count);
+}
+
+static void
+ids_add(HyPackageSet pset, Id id)
+{
+    int i = ids_find(pset, id);
+
+    if (i < pset->nids && pset->ids[i] == id)
+	return;
+    pset->ids = solv_extend(pset->ids, pset->nids, 1, sizeof(Id), IDS_BLOCK);
+    memmove(pset->ids + i + 1, pset->ids + i, (pset->nids - i) * sizeof(Id));
+    pset->ids[i] = id;
+    pset->nids++;
+}
 
-    if (previous >= 0) {
-	ti += previous >> 3;
-	unsigned char byte = *ti; // byte with the previous match
-	byte >>= (previous & 7) + 1; // shift away all previous 1 bits
-	enabled = _BitCountLookup[byte]; // are there any 1 bits left?
-
-	for (id = previous + 1; enabled; byte >>= 1, id++)
-	    if (byte & 0x01)
-		return id;
-	index = 0; // we are looking for the immediately following index
-	ti++;
+static int
+has_id(HyPackageSet pset, Id id)
+{
+    if (pset->sparse) {
+	int i = ids_find(pset, id);
+	return i < pset->nids && pset->ids[i] == id;
     }
+    return id < (pset->map.size << 3) && MAPTST(&pset->map, id);
+}
 
-    while (ti < end) {
-	enabled = _BitCountLookup[*ti];
+/* the 'index'-th set bit, whole words are skipped by their popcount */
+static Id
+map_index2id(Map *map, unsigned index)
+{
+    const unsigned char *ti = map->map, *end = ti + map->size;
 
-	if (index >= enabled ){
+    for (; ti + sizeof(uint64_t) <= end; ti += sizeof(uint64_t)) {
+	uint64_t word;
+	memcpy(&word, ti, sizeof(word));
+	unsigned enabled = __builtin_popcountll(word);
+	if (index < enabled)
+	    break;
+	index -= enabled;
+    }
+    for (; ti < end; ++ti) {
+	unsigned enabled = __builtin_popcount(*ti);
+	if (index >= enabled) {
 	    index -= enabled;
-	    ti++;
 	    continue;
 	}
-	id = (ti - map->map) << 3;
-
-	index++;
-	for (unsigned char byte = *ti; index; byte >>= 1) {
-	    if ((byte & 0x01))
-		index--;
-	    if (index)
-		id++;
-	}
-	return id;
+	for (unsigned char byte = *ti, bit = 0; ; byte >>= 1, ++bit)
+	    if ((byte & 0x01) && index-- == 0)
+		return ((ti - map->map) << 3) + bit;
     }
     return -1;
 }
 
+static Id
+packageset_index2id(HyPackageSet pset, int index)
+{
+    if (pset->sparse)
+	return index >= 0 && index < pset->nids ? pset->ids[index] : -1;
+    return map_index2id(&pset->map, index);
+}
+
+/* the 'index'-th package, 'previous' is the one at 'index' - 1 or -1 if not
+   known */
 Id
 packageset_get_pkgid(HyPackageSet pset, int index, Id previous)
 {
-    Id id = map_index2id(&pset->map, index, previous);
+    Id id;
+
+    if (previous >= 0 && !pset->sparse)
+	id = map_next(&pset->map, previous + 1);
+    else
+	id = packageset_index2id(pset, index);
     assert(id >= 0);
     return id;
 }
@@ -97,37 +194,115 @@ packageset_get_pkgid(HyPackageSet pset, int index, Id previous)
 unsigned
 map_count(Map *m)
 {
-    unsigned char *ti = m->map;
-    unsigned char *end = ti + m->size;
+    const unsigned char *ti = m->map, *end = ti + m->size;
     unsigned c = 0;
 
-    while (ti < end)
-	c += _BitCountLookup[*ti++];
-
+    for (; ti + sizeof(uint64_t) <= end; ti += sizeof(uint64_t)) {
+	uint64_t word;
+	memcpy(&word, ti, sizeof(word));
+	c += __builtin_popcountll(word);
+    }
+    for (; ti < end; ++ti)
+	c += __builtin_popcount(*ti);
     return c;
 }
 
+/* returns the lowest set bit at or after 'from', -1 if there is none. runs of
+   clear bits are skipped a machine word at a time. */
+Id
+map_next(Map *m, Id from)
+{
+    const unsigned char *ti, *end = m->map + m->size;
+    unsigned char byte;
+
+    if (from < 0 || from >> 3 >= m->size)
+	return -1;
+    ti = m->map + (from >> 3);
+    byte = *ti >> (from & 7);
+    if (byte)
+	return from + __builtin_ctz(byte);
+
+    for (++ti; ti < end && (uintptr_t)ti % sizeof(uint64_t); ++ti)
+	if (*ti)
+	    goto found;
+    for (; ti + sizeof(uint64_t) <= end; ti += sizeof(uint64_t)) {
+	uint64_t word;
+	memcpy(&word, ti, sizeof(word));
+	if (word)
+	    break;
+    }
+    for (; ti < end; ++ti)
+	if (*ti)
+	    goto found;
+    return -1;
+
+ found:
+    return ((ti - m->map) << 3) + __builtin_ctz(*ti);
+}
+
 HyPackageSet
 packageset_from_bitmap(HySack sack, Map *m)
 {
     HyPackageSet pset = solv_calloc(1, sizeof(*pset));
     pset->sack = sack;
     map_init_clone(&pset->map, m);
+    choose_representation(pset);
     return pset;
 }
 
+static int
+id_cmp(const void *ap, const void *bp, void *dp)
+{
+    return *(const Id *)ap - *(const Id *)bp;
+}
+
+/* the set of the 'count' packages in 'ids', in any order */
+HyPackageSet
+packageset_from_ids(HySack sack, const Id *ids, int count)
+{
+    HyPackageSet pset = solv_calloc(1, sizeof(*pset));
+    pset->sack = sack;
+    pset->sparse = 1;
+    pset->ids = solv_extend_resize(NULL, count, sizeof(Id), IDS_BLOCK);
+    memcpy(pset->ids, ids, count * sizeof(Id));
+    solv_sort(pset->ids, count, sizeof(Id), id_cmp, NULL);
+    for (int i = 0; i < count; ++i)
+	if (pset->nids == 0 || pset->ids[pset->nids - 1] != pset->ids[i])
+	    pset->ids[pset->nids++] = pset->ids[i];
+    choose_representation(pset);
+    return pset;
+}
+
+HySack
+packageset_get_sack(HyPackageSet pset)
+{
+    return pset->sack;
+}
+
+/* the bitmap of a set from packageset_clone_dense() */
 Map *
 packageset_get_map(HyPackageSet pset)
 {
+    assert(!pset->sparse);
     return &pset->map;
 }
 
+/* initialize 'm' to a bitmap of the set, the set itself stays as it is */
+void
+packageset_to_map(HyPackageSet pset, Map *m)
+{
+    if (pset->sparse)
+	ids_to_map(pset, m);
+    else
+	map_init_clone(m, &pset->map);
+}
+
 HyPackageSet
 hy_packageset_create(HySack sack)
 {
     HyPackageSet pset = solv_calloc(1, sizeof(*pset));
     pset->sack = sack;
-    map_init(&pset->map, sack_pool(sack)->nsolvables);
+    pset->sparse = 1;
     return pset;
 }
 
@@ -136,34 +311,56 @@ hy_packageset_clone(HyPackageSet pset)
 {
     HyPackageSet new = solv_malloc(sizeof(*new));
     memcpy(new, pset, sizeof(*pset));
-    map_init_clone(&new->map, &pset->map);
+    if (pset->sparse)
+	new->ids = solv_memdup2(pset->ids, pset->nids, sizeof(Id));
+    else
+	map_init_clone(&new->map, &pset->map);
+    return new;
+}
+
+/* a copy of the set that is kept as a bitmap, for the query filters that
+   read it from several threads */
+HyPackageSet
+packageset_clone_dense(HyPackageSet pset)
+{
+    HyPackageSet new = hy_packageset_clone(pset);
+    make_dense(new);
     return new;
 }
 
 void
 hy_packageset_free(HyPackageSet pset)
 {
-    map_free(&pset->map);
+    if (pset->sparse)
+	solv_free(pset->ids);
+    else
+	map_free(&pset->map);
     solv_free(pset);
 }
 
 void
 hy_packageset_add(HyPackageSet pset, HyPackage pkg)
 {
-    MAPSET(&pset->map, package_id(pkg));
+    if (pset->sparse) {
+	ids_add(pset, package_id(pkg));
+	choose_representation(pset);
+    } else
+	MAPSET(&pset->map, package_id(pkg));
     hy_package_free(pkg);
 }
 
 unsigned
 hy_packageset_count(HyPackageSet pset)
 {
+    if (pset->sparse)
+	return pset->nids;
     return map_count(&pset->map);
 }
 
 HyPackage
 hy_packageset_get_clone(HyPackageSet pset, int index)
 {
-    Id id = map_index2id(&pset->map, index, -1);
+    Id id = packageset_index2id(pset, index);
     if (id < 0)
 	return NULL;
     return package_create(pset->sack, id);
@@ -172,5 +369,129 @@ hy_packageset_get_clone(HyPackageSet pset, int index)
 int
 hy_packageset_has(HyPackageSet pset, HyPackage pkg)
 {
-    return MAPTST(&pset->map, package_id(pkg));
+    return has_id(pset, package_id(pkg));
+}
+
+/**
+ * Adds the packages of 'other' to 'pset'.
+ */
+void
+hy_packageset_union(HyPackageSet pset, HyPackageSet other)
+{
+    if (pset->sparse && other->sparse) {
+	Id *ids = solv_extend_resize(NULL, pset->nids + other->nids,
+				     sizeof(Id), IDS_BLOCK);
+	int i = 0, j = 0, n = 0;
+
+	while (i < pset->nids || j < other->nids) {
+	    if (j == other->nids ||
+		(i < pset->nids && pset->ids[i] < other->ids[j]))
+		ids[n++] = pset->ids[i++];
+	    else if (i == pset->nids || other->ids[j] < pset->ids[i])
+		ids[n++] = other->ids[j++];
+	    else {
+		ids[n++] = pset->ids[i++];
+		j++;
+	    }
+	}
+	solv_free(pset->ids);
+	pset->ids = ids;
+	pset->nids = n;
+	choose_representation(pset);
+	return;
+    }
+    make_dense(pset);
+    if (other->sparse)
+	for (int i = 0; i < other->nids; ++i)
+	    MAPSET(&pset->map, other->ids[i]);
+    else
+	map_or(&pset->map, &other->map);
+}
+
+/**
+ * Keeps only the packages of 'pset' that are also in 'other'.
+ */
+void
+hy_packageset_intersect(HyPackageSet pset, HyPackageSet other)
+{
+    int n = 0;
+
+    if (pset->sparse) {
+	for (int i = 0; i < pset->nids; ++i)
+	    if (has_id(other, pset->ids[i]))
+		pset->ids[n++] = pset->ids[i];
+	pset->nids = n;
+    } else if (other->sparse) {
+	Id *ids = solv_extend_resize(NULL, other->nids, sizeof(Id), IDS_BLOCK);
+	for (int i = 0; i < other->nids; ++i)
+	    if (has_id(pset, other->ids[i]))
+		ids[n++] = other->ids[i];
+	map_free(&pset->map);
+	pset->ids = ids;
+	pset->nids = n;
+	pset->sparse = 1;
+    } else {
+	map_and(&pset->map, &other->map);
+	choose_representation(pset);
+    }
+}
+
+/**
+ * Removes the packages of 'other' from 'pset'.
+ */
+void
+hy_packageset_difference(HyPackageSet pset, HyPackageSet other)
+{
+    int n = 0;
+
+    if (pset->sparse) {
+	for (int i = 0; i < pset->nids; ++i)
+	    if (!has_id(other, pset->ids[i]))
+		pset->ids[n++] = pset->ids[i];
+	pset->nids = n;
+	return;
+    }
+    if (other->sparse)
+	for (int i = 0; i < other->nids; ++i)
+	    MAPCLR(&pset->map, other->ids[i]);
+    else
+	map_subtract(&pset->map, &other->map);
+    choose_representation(pset);
+}
+
+/**
+ * Calls 'cb' for the packages of 'pset' in the order of their Ids, until it
+ * returns nonzero. Returns what the last call returned, 0 for an empty set.
+ *
+ * The package is only valid during the call, the callback has to take a
+ * reference with hy_package_link() to keep it.
+ */
+int
+hy_packageset_iterate(HyPackageSet pset, hy_packageset_callback cb,
+		      void *cb_data)
+{
+    HyPackage pkg = NULL;
+    int ret = 0;
+
+    for (int i = 0; !ret; ++i) {
+	Id id;
+	if (pset->sparse)
+	    id = i < pset->nids ? pset->ids[i] : -1;
+	else
+	    id = map_next(&pset->map, pkg ? package_id(pkg) + 1 : 0);
+	if (id < 0)
+	    break;
+	// reuse the package unless the callback kept it
+	if (pkg && pkg->nrefs == 1 && pkg->userdata == NULL)
+	    pkg->id = id;
+	else {
+	    if (pkg)
+		hy_package_free(pkg);
+	    pkg = package_create(pset->sack, id);
+	}
+	ret = cb(pkg, cb_data);
+    }
+    if (pkg)
+	hy_package_free(pkg);
+    return ret;
 }
@@ -35,6 +35,11 @@ void hy_packageset_add(HyPackageSet pset, HyPackage pkg);
 unsigned hy_packageset_count(HyPackageSet pset);
 HyPackage hy_packageset_get_clone(HyPackageSet pset, int index);
 int hy_packageset_has(HyPackageSet pset, HyPackage pkg);
+void hy_packageset_union(HyPackageSet pset, HyPackageSet other);
+void hy_packageset_intersect(HyPackageSet pset, HyPackageSet other);
+void hy_packageset_difference(HyPackageSet pset, HyPackageSet other);
+int hy_packageset_iterate(HyPackageSet pset, hy_packageset_callback cb,
+			  void *cb_data);
 
 #ifdef __cplusplus
 }
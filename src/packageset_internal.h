@@ -29,8 +29,13 @@
 #include "packageset.h"
 
 unsigned map_count(Map *m);
+Id map_next(Map *m, Id from);
 HyPackageSet packageset_from_bitmap(HySack sack, Map *m);
+HyPackageSet packageset_from_ids(HySack sack, const Id *ids, int count);
+HyPackageSet packageset_clone_dense(HyPackageSet pset);
 Map *packageset_get_map(HyPackageSet pset);
+void packageset_to_map(HyPackageSet pset, Map *m);
+HySack packageset_get_sack(HyPackageSet pset);
 Id packageset_get_pkgid(HyPackageSet pset, int index, Id previous);
 
 #endif // HY_PACKAGESET_INTERNAL_H
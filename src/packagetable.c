@@ -0,0 +1,387 @@
+/*
+ * Copyright (C) 2015 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+// libsolv
+#include <solv/knownid.h>
+#include <solv/repo.h>
+#include <solv/util.h>
+
+// hawkey
+#include "package_internal.h"
+#include "packagelist.h"
+#include "packageset_internal.h"
+#include "packagetable.h"
+#include "repo_internal.h"
+#include "sack_internal.h"
+
+#define ARENA_BLOCK 65535
+
+/* attributes of many packages at once, one array per column. the strings
+   are all in one arena, a string column holds their offsets, -1 for none */
+struct _HyPackageTable {
+    int nrows;
+    int ncolumns;
+    int *columns;
+    int **offsets;		/* per column, NULL for number columns */
+    unsigned long long **nums;	/* per column, NULL for string columns */
+    char *arena;
+    int arena_len;
+};
+
+/* remembers where the string of every pool Id went, so a column of names or
+   arches stores each distinct one once */
+struct _IdOffsets {
+    int *offsets;		/* offset + 1, 0 if not stored yet */
+    int noffsets;
+};
+
+static int
+is_num_column(int column)
+{
+    return column >= HY_COLUMN_EPOCH;
+}
+
+/* room for a string of 'len' bytes and its terminator at the end of the
+   arena, returns its offset */
+static int
+arena_reserve(HyPackageTable table, int len)
+{
+    int offset = table->arena_len;
+
+    table->arena = solv_extend(table->arena, table->arena_len, len + 1, 1,
+			       ARENA_BLOCK);
+    table->arena[offset + len] = '\0';
+    table->arena_len += len + 1;
+    return offset;
+}
+
+static int
+arena_add(HyPackageTable table, const char *str, int len)
+{
+    int offset = arena_reserve(table, len);
+
+    memcpy(table->arena + offset, str, len);
+    return offset;
+}
+
+static int
+arena_add_str(HyPackageTable table, const char *str)
+{
+    if (str == NULL)
+	return -1;
+    return arena_add(table, str, strlen(str));
+}
+
+static int
+arena_add_id(HyPackageTable table, Pool *pool, struct _IdOffsets *cache, Id id)
+{
+    if (id <= 0)
+	return -1;
+    if (id >= cache->noffsets) {
+	cache->offsets = solv_extend_realloc(cache->offsets, id + 1,
+					     sizeof(int), 255);
+	memset(cache->offsets + cache->noffsets, 0,
+	       (id + 1 - cache->noffsets) * sizeof(int));
+	cache->noffsets = id + 1;
+    }
+    if (cache->offsets[id] == 0)
+	cache->offsets[id] = arena_add_str(table, pool_id2str(pool, id)) + 1;
+    return cache->offsets[id] - 1;
+}
+
+/* the spans of version and release in 'evr', see pool_split_evr() */
+static void
+evr_spans(const char *evr, const char **v, int *vlen, const char **r,
+	  int *rlen)
+{
+    const char *e;
+
+    for (e = evr + 1; *e != ':' && *e != '-' && *e != '\0'; ++e)
+	;
+    *v = *e == ':' ? e + 1 : evr;
+    *r = **v ? strchr(*v + 1, '-') : NULL;
+    if (*r) {
+	*vlen = *r - *v;
+	++*r;
+	*rlen = strlen(*r);
+    } else {
+	*vlen = strlen(*v);
+	*rlen = 0;
+    }
+}
+
+static unsigned long long
+evr_epoch(const char *evr)
+{
+    const char *e;
+
+    for (e = evr; *e >= '0' && *e <= '9'; ++e)
+	;
+    return *e == ':' ? strtoull(evr, NULL, 10) : 0;
+}
+
+/* pool_solvable2str() straight into the arena */
+static int
+arena_add_nevra(HyPackageTable table, Pool *pool, Solvable *s)
+{
+    const char *n = pool_id2str(pool, s->name);
+    const char *e = s->evr ? pool_id2str(pool, s->evr) : "";
+    const char *a = s->arch ? pool_id2str(pool, s->arch) : "";
+    int nlen = strlen(n), elen = strlen(e), alen = strlen(a);
+    int offset = arena_reserve(table, nlen + (elen ? elen + 1 : 0) +
+			       (alen ? alen + 1 : 0));
+    char *p = table->arena + offset;
+
+    memcpy(p, n, nlen);
+    p += nlen;
+
+    if (elen) {
+	*p++ = '-';
+	memcpy(p, e, elen);
+	p += elen;
+    }
+    if (alen) {
+	*p++ = '.';
+	memcpy(p, a, alen);
+    }
+    return offset;
+}
+
+static int
+string_cell(HyPackageTable table, Pool *pool, struct _IdOffsets *cache,
+	    int column, Id p)
+{
+    Solvable *s = pool_id2solvable(pool, p);
+    const char *v, *r;
+    int vlen, rlen;
+
+    switch (column) {
+    case HY_COLUMN_NAME:
+	return arena_add_id(table, pool, cache, s->name);
+    case HY_COLUMN_ARCH:
+	return arena_add_id(table, pool, cache, s->arch);
+    case HY_COLUMN_EVR:
+	return arena_add_id(table, pool, cache, s->evr);
+    case HY_COLUMN_VERSION:
+	evr_spans(pool_id2str(pool, s->evr), &v, &vlen, &r, &rlen);
+	return arena_add(table, v, vlen);
+    case HY_COLUMN_RELEASE:
+	evr_spans(pool_id2str(pool, s->evr), &v, &vlen, &r, &rlen);
+	return r ? arena_add(table, r, rlen) : -1;
+    case HY_COLUMN_NEVRA:
+	return arena_add_nevra(table, pool, s);
+    case HY_COLUMN_REPONAME:
+	return arena_add_str(table, s->repo->name);
+    case HY_COLUMN_SOURCERPM:
+	return arena_add_str(table, solvable_lookup_sourcepkg(s));
+    case HY_COLUMN_LOCATION:
+	return arena_add_str(table, solvable_get_location(s, NULL));
+    case HY_COLUMN_SUMMARY:
+	return arena_add_str(table, solvable_lookup_str(s, SOLVABLE_SUMMARY));
+    case HY_COLUMN_URL:
+	return arena_add_str(table, solvable_lookup_str(s, SOLVABLE_URL));
+    case HY_COLUMN_LICENSE:
+	return arena_add_str(table, solvable_lookup_str(s, SOLVABLE_LICENSE));
+    default:
+	assert(0);
+	return -1;
+    }
+}
+
+static unsigned long long
+num_cell(Pool *pool, int column, Id p)
+{
+    Solvable *s = pool_id2solvable(pool, p);
+    Id key;
+
+    switch (column) {
+    case HY_COLUMN_EPOCH:
+	return evr_epoch(pool_id2str(pool, s->evr));
+    case HY_COLUMN_DOWNLOADSIZE:
+	key = SOLVABLE_DOWNLOADSIZE;
+	break;
+    case HY_COLUMN_INSTALLSIZE:
+	key = SOLVABLE_INSTALLSIZE;
+	break;
+    case HY_COLUMN_SIZE:
+	key = s->repo == pool->installed ? SOLVABLE_INSTALLSIZE :
+					   SOLVABLE_DOWNLOADSIZE;
+	break;
+    case HY_COLUMN_BUILDTIME:
+	key = SOLVABLE_BUILDTIME;
+	break;
+    case HY_COLUMN_INSTALLTIME:
+	key = SOLVABLE_INSTALLTIME;
+	break;
+    case HY_COLUMN_MEDIANR:
+	key = SOLVABLE_MEDIANR;
+	break;
+    case HY_COLUMN_ID:
+	return p;
+    default:
+	assert(0);
+	return 0;
+    }
+    return solvable_lookup_num(s, key, 0);
+}
+
+/* fill the table column by column, so one pass stays in one kind of data.
+   'pool' can only be NULL without any 'ids'. */
+static HyPackageTable
+packagetable_create(Pool *pool, const Id *ids, int nids, const int *columns,
+		    int ncolumns)
+{
+    HyPackageTable table = solv_calloc(1, sizeof(*table));
+    struct _IdOffsets cache;
+    Repo *repo;
+    int i;
+
+    table->nrows = nids;
+    table->ncolumns = ncolumns;
+    table->columns = solv_memdup2(columns, ncolumns, sizeof(int));
+    table->offsets = solv_calloc(ncolumns, sizeof(int *));
+    table->nums = solv_calloc(ncolumns, sizeof(unsigned long long *));
+    if (pool) {
+	FOR_REPOS(i, repo)
+	    repo_internalize_trigger(repo);
+    }
+
+    for (int c = 0; c < ncolumns; ++c) {
+	assert(columns[c] >= 0 && columns[c] < _HY_COLUMN_NUM);
+	if (is_num_column(columns[c])) {
+	    table->nums[c] = solv_calloc(nids + 1, sizeof(unsigned long long));
+	    for (int row = 0; row < nids; ++row)
+		table->nums[c][row] = num_cell(pool, columns[c], ids[row]);
+	    continue;
+	}
+	memset(&cache, 0, sizeof(cache));
+	table->offsets[c] = solv_calloc(nids + 1, sizeof(int));
+	for (int row = 0; row < nids; ++row)
+	    table->offsets[c][row] = string_cell(table, pool, &cache,
+						 columns[c], ids[row]);
+	solv_free(cache.offsets);
+    }
+    return table;
+}
+
+/**
+ * Export the 'columns' of all the packages in 'pset', in the order of their
+ * Ids.
+ *
+ * The string columns point into a single arena rather than allocating per
+ * package, the strings of pool Ids (names, arches, EVRs) are stored once.
+ */
+HyPackageTable
+hy_packagetable_from_set(HyPackageSet pset, const int *columns, int ncolumns)
+{
+    Pool *pool = sack_pool(packageset_get_sack(pset));
+    int nids = hy_packageset_count(pset);
+    Id *ids = solv_calloc(nids + 1, sizeof(Id));
+    Id id = -1;
+
+    for (int i = 0; i < nids; ++i)
+	ids[i] = id = packageset_get_pkgid(pset, i, id);
+    HyPackageTable table = packagetable_create(pool, ids, nids, columns,
+					       ncolumns);
+    solv_free(ids);
+    return table;
+}
+
+/**
+ * Export the 'columns' of the packages in 'plist', in the list's order.
+ */
+HyPackageTable
+hy_packagetable_from_list(HyPackageList plist, const int *columns,
+			  int ncolumns)
+{
+    int nids = hy_packagelist_count(plist);
+    Id *ids = solv_calloc(nids + 1, sizeof(Id));
+    Pool *pool = NULL;
+    HyPackageTable table;
+
+    for (int i = 0; i < nids; ++i) {
+	HyPackage pkg = hy_packagelist_get(plist, i);
+	ids[i] = package_id(pkg);
+	pool = package_pool(pkg);
+    }
+    table = packagetable_create(pool, ids, nids, columns, ncolumns);
+    solv_free(ids);
+    return table;
+}
+
+void
+hy_packagetable_free(HyPackageTable table)
+{
+    for (int c = 0; c < table->ncolumns; ++c) {
+	solv_free(table->offsets[c]);
+	solv_free(table->nums[c]);
+    }
+    solv_free(table->offsets);
+    solv_free(table->nums);
+    solv_free(table->columns);
+    solv_free(table->arena);
+    solv_free(table);
+}
+
+int
+hy_packagetable_count(HyPackageTable table)
+{
+    return table->nrows;
+}
+
+const char *
+hy_packagetable_get_arena(HyPackageTable table)
+{
+    return table->arena;
+}
+
+/**
+ * Offsets into the arena of the strings in the 'column'-th requested column,
+ * -1 where a package has none. NULL for a number column.
+ */
+const int *
+hy_packagetable_get_offsets(HyPackageTable table, int column)
+{
+    assert(column >= 0 && column < table->ncolumns);
+    return table->offsets[column];
+}
+
+/**
+ * The numbers in the 'column'-th requested column, NULL for a string column.
+ */
+const unsigned long long *
+hy_packagetable_get_nums(HyPackageTable table, int column)
+{
+    assert(column >= 0 && column < table->ncolumns);
+    return table->nums[column];
+}
+
+const char *
+hy_packagetable_get_str(HyPackageTable table, int column, int row)
+{
+    const int *offsets = hy_packagetable_get_offsets(table, column);
+
+    assert(offsets && row >= 0 && row < table->nrows);
+    return offsets[row] < 0 ? NULL : table->arena + offsets[row];
+}
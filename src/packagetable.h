@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2015 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef HY_PACKAGETABLE_H
+#define HY_PACKAGETABLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// hawkey
+#include "types.h"
+
+enum _hy_package_column_e {
+    /* string columns */
+    HY_COLUMN_NAME,
+    HY_COLUMN_ARCH,
+    HY_COLUMN_EVR,
+    HY_COLUMN_VERSION,
+    HY_COLUMN_RELEASE,
+    HY_COLUMN_NEVRA,
+    HY_COLUMN_REPONAME,
+    HY_COLUMN_SOURCERPM,
+    HY_COLUMN_LOCATION,
+    HY_COLUMN_SUMMARY,
+    HY_COLUMN_URL,
+    HY_COLUMN_LICENSE,
+    /* number columns */
+    HY_COLUMN_EPOCH,
+    HY_COLUMN_DOWNLOADSIZE,
+    HY_COLUMN_INSTALLSIZE,
+    HY_COLUMN_SIZE,
+    HY_COLUMN_BUILDTIME,
+    HY_COLUMN_INSTALLTIME,
+    HY_COLUMN_MEDIANR,
+    HY_COLUMN_ID,
+    _HY_COLUMN_NUM
+};
+
+typedef struct _HyPackageTable * HyPackageTable;
+
+HyPackageTable hy_packagetable_from_set(HyPackageSet pset, const int *columns,
+					int ncolumns);
+HyPackageTable hy_packagetable_from_list(HyPackageList plist,
+					 const int *columns, int ncolumns);
+void hy_packagetable_free(HyPackageTable table);
+int hy_packagetable_count(HyPackageTable table);
+const char *hy_packagetable_get_arena(HyPackageTable table);
+const int *hy_packagetable_get_offsets(HyPackageTable table, int column);
+const unsigned long long *hy_packagetable_get_nums(HyPackageTable table,
+						   int column);
+const char *hy_packagetable_get_str(HyPackageTable table, int column, int row);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HY_PACKAGETABLE_H */
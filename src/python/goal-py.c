@@ -99,13 +99,16 @@ args_pkg_sltr_parse(PyObject *args, PyObject *kwds,
 static int
 args_run_parse(PyObject *args, PyObject *kwds, int *flags, PyObject **callback_p)
 {
-    char *kwlist[] = {"callback", "allow_uninstall", "force_best", NULL};
+    char *kwlist[] = {"callback", "allow_uninstall", "force_best",
+		      "plan_installonly", NULL};
     int allow_uninstall = 0;
     int force_best = 0;
+    int plan_installonly = 0;
     PyObject *callback = NULL;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|Oii", kwlist,
-				     &callback, &allow_uninstall, &force_best))
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|Oiii", kwlist,
+				     &callback, &allow_uninstall, &force_best,
+				     &plan_installonly))
 	return 0;
 
     if (callback) {
@@ -128,6 +131,8 @@ args_run_parse(PyObject *args, PyObject *kwds, int *flags, PyObject **callback_p
 	*flags |= HY_ALLOW_UNINSTALL;
     if (force_best)
 	*flags |= HY_FORCE_BEST;
+    if (plan_installonly)
+	*flags |= HY_PLAN_INSTALLONLY;
     return 1;
 }
 
@@ -157,23 +157,17 @@ static PyObject *
 package_repr(_PackageObject *self)
 {
     HyPackage pkg = self->package;
-    char *nevra = hy_package_get_nevra(pkg);
-    PyObject *repr;
 
-    repr = PyString_FromFormat("<hawkey.Package object id %ld, %s, %s>",
-			       package_hash(self), nevra,
+    return PyString_FromFormat("<hawkey.Package object id %ld, %s, %s>",
+			       package_hash(self),
+			       hy_package_get_nevra_cached(pkg),
 			       hy_package_get_reponame(pkg));
-    solv_free(nevra);
-    return repr;
 }
 
 static PyObject *
 package_str(_PackageObject *self)
 {
-    char *cstr = hy_package_get_nevra(self->package);
-    PyObject *ret = PyString_FromString(cstr);
-    solv_free(cstr);
-    return ret;
+    return PyString_FromString(hy_package_get_nevra_cached(self->package));
 }
 
 long package_hash(_PackageObject *self)
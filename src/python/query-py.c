@@ -26,6 +26,7 @@
 // hawkey
 #include "src/packagelist.h"
 #include "src/packageset_internal.h"
+#include "src/packagetable.h"
 #include "src/query_internal.h"
 #include "src/reldep.h"
 
@@ -133,8 +134,7 @@ query_init(_QueryObject * self, PyObject *args, PyObject *kwds)
 static PyObject *
 get_evaluated(_QueryObject *self, void *unused)
 {
-    HyQuery q = self->query;
-    return PyBool_FromLong((long)q->result);
+    return PyBool_FromLong((long)query_evaluated(self->query));
 }
 
 static PyGetSetDef query_getsetters[] = {
@@ -315,9 +315,110 @@ run(_QueryObject *self, PyObject *unused)
     return list;
 }
 
+static const struct {
+    const char *name;
+    int column;
+} column_names[] = {
+    {"name", HY_COLUMN_NAME},
+    {"arch", HY_COLUMN_ARCH},
+    {"evr", HY_COLUMN_EVR},
+    {"version", HY_COLUMN_VERSION},
+    {"release", HY_COLUMN_RELEASE},
+    {"nevra", HY_COLUMN_NEVRA},
+    {"reponame", HY_COLUMN_REPONAME},
+    {"sourcerpm", HY_COLUMN_SOURCERPM},
+    {"location", HY_COLUMN_LOCATION},
+    {"summary", HY_COLUMN_SUMMARY},
+    {"url", HY_COLUMN_URL},
+    {"license", HY_COLUMN_LICENSE},
+    {"epoch", HY_COLUMN_EPOCH},
+    {"downloadsize", HY_COLUMN_DOWNLOADSIZE},
+    {"installsize", HY_COLUMN_INSTALLSIZE},
+    {"size", HY_COLUMN_SIZE},
+    {"buildtime", HY_COLUMN_BUILDTIME},
+    {"installtime", HY_COLUMN_INSTALLTIME},
+    {"medianr", HY_COLUMN_MEDIANR},
+};
+
+static PyObject *
+column_to_pylist(HyPackageTable table, int column)
+{
+    const int count = hy_packagetable_count(table);
+    const unsigned long long *nums = hy_packagetable_get_nums(table, column);
+    const int *offsets = hy_packagetable_get_offsets(table, column);
+    const char *arena = hy_packagetable_get_arena(table);
+    PyObject *list = PyList_New(count);
+    PyObject *item = NULL;
+
+    if (list == NULL)
+	return NULL;
+    for (int i = 0; i < count; ++i) {
+	if (nums)
+	    item = PyLong_FromUnsignedLongLong(nums[i]);
+	else if (offsets[i] < 0) {
+	    item = Py_None;
+	    Py_INCREF(item);
+	} else if (i > 0 && offsets[i] == offsets[i - 1]) {
+	    // repeated names and arches share the arena and the objects
+	    item = PyList_GET_ITEM(list, i - 1);
+	    Py_INCREF(item);
+	} else
+	    item = PyUnicode_FromString(arena + offsets[i]);
+	if (item == NULL) {
+	    Py_DECREF(list);
+	    return NULL;
+	}
+	PyList_SET_ITEM(list, i, item);
+    }
+    return list;
+}
+
+static PyObject *
+columns(_QueryObject *self, PyObject *args)
+{
+    const int ncolumns = PyTuple_Size(args);
+    const int nnames = sizeof(column_names) / sizeof(*column_names);
+    int cols[ncolumns + 1];
+
+    for (int i = 0; i < ncolumns; ++i) {
+	PyObject *tmp_py_str = NULL;
+	const char *name = pycomp_get_string(PyTuple_GET_ITEM(args, i),
+					     &tmp_py_str);
+	int j = 0;
+
+	while (name && j < nnames && strcmp(name, column_names[j].name))
+	    ++j;
+	Py_XDECREF(tmp_py_str);
+	if (name == NULL || j == nnames) {
+	    PyErr_SetString(HyExc_Value, "Unknown package attribute.");
+	    return NULL;
+	}
+	cols[i] = column_names[j].column;
+    }
+
+    HyPackageSet pset = hy_query_run_set(self->query);
+    HyPackageTable table = hy_packagetable_from_set(pset, cols, ncolumns);
+    PyObject *ret = PyTuple_New(ncolumns);
+
+    hy_packageset_free(pset);
+    for (int i = 0; ret && i < ncolumns; ++i) {
+	PyObject *list = column_to_pylist(table, i);
+	if (list == NULL) {
+	    Py_DECREF(ret);
+	    ret = NULL;
+	    break;
+	}
+	PyTuple_SET_ITEM(ret, i, list);
+    }
+    hy_packagetable_free(table);
+    return ret;
+}
+
 static struct PyMethodDef query_methods[] = {
     {"clear", (PyCFunction)clear, METH_NOARGS,
      NULL},
+    {"columns", (PyCFunction)columns, METH_VARARGS,
+     NULL},
     {"filter", (PyCFunction)filter, METH_VARARGS,
      NULL},
     {"run", (PyCFunction)run, METH_NOARGS,
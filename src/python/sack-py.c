@@ -250,10 +250,57 @@ set_installonly_limit(_SackObject *self, PyObject *obj, void *unused)
     return 0;
 }
 
+static int
+set_query_threads(_SackObject *self, PyObject *obj, void *unused)
+{
+    int nthreads = (int)PyLong_AsLong(obj);
+    if (PyErr_Occurred())
+	return -1;
+    hy_sack_set_query_threads(self->sack, nthreads);
+    return 0;
+}
+
+static int
+set_query_cache_size(_SackObject *self, PyObject *obj, void *unused)
+{
+    int nentries = (int)PyLong_AsLong(obj);
+    if (PyErr_Occurred())
+	return -1;
+    hy_sack_set_query_cache_size(self->sack, nentries);
+    return 0;
+}
+
+static PyObject *
+get_query_cache_hits(_SackObject *self, void *unused)
+{
+    return PyLong_FromUnsignedLong(hy_sack_get_query_cache_hits(self->sack));
+}
+
+static PyObject *
+get_query_cache_misses(_SackObject *self, void *unused)
+{
+    return PyLong_FromUnsignedLong(hy_sack_get_query_cache_misses(self->sack));
+}
+
+static int
+set_solver_cache_size(_SackObject *self, PyObject *obj, void *unused)
+{
+    int nsolvers = (int)PyLong_AsLong(obj);
+    if (PyErr_Occurred())
+	return -1;
+    hy_sack_set_solver_cache_size(self->sack, nsolvers);
+    return 0;
+}
+
 static PyGetSetDef sack_getsetters[] = {
     {"cache_dir",	(getter)get_cache_dir, NULL, NULL, NULL},
     {"installonly",	NULL, (setter)set_installonly, NULL, NULL},
     {"installonly_limit",	NULL, (setter)set_installonly_limit, NULL, NULL},
+    {"query_threads",	NULL, (setter)set_query_threads, NULL, NULL},
+    {"query_cache_size",	NULL, (setter)set_query_cache_size, NULL, NULL},
+    {"query_cache_hits",	(getter)get_query_cache_hits, NULL, NULL, NULL},
+    {"query_cache_misses",	(getter)get_query_cache_misses, NULL, NULL, NULL},
+    {"solver_cache_size",	NULL, (setter)set_solver_cache_size, NULL, NULL},
     {NULL}			/* sentinel */
 };
 
@@ -373,6 +420,32 @@ add_includes(_SackObject *self, PyObject *seq)
     Py_RETURN_NONE;
 }
 
+static PyObject *
+begin_edit(_SackObject *self, PyObject *unused)
+{
+    hy_sack_begin_edit(self->sack);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+end_edit(_SackObject *self, PyObject *unused)
+{
+    if (hy_sack_end_edit(self->sack)) {
+	PyErr_SetString(HyExc_Value, "No edit to end.");
+	return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+freeze(_SackObject *self, PyObject *unused)
+{
+    int ret = hy_sack_freeze(self->sack);
+    if (ret2e(ret, "Can not freeze the sack."))
+	return NULL;
+    Py_RETURN_NONE;
+}
+
 static PyObject *
 disable_repo(_SackObject *self, PyObject *reponame)
 {
@@ -460,6 +533,59 @@ load_yum_repo(_SackObject *self, PyObject *args, PyObject *kwds)
     Py_RETURN_NONE;
 }
 
+static PyObject *
+load_yum_repos(_SackObject *self, PyObject *args, PyObject *kwds)
+{
+    char *kwlist[] = {"repos", "build_cache", "load_filelists", "load_presto",
+		      "load_updateinfo", "nthreads", NULL};
+
+    PyObject *repos = NULL;
+    int build_cache = 0, load_filelists = 0, load_presto = 0, load_updateinfo = 0;
+    int nthreads = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|iiiii", kwlist, &repos,
+				     &build_cache, &load_filelists,
+				     &load_presto, &load_updateinfo,
+				     &nthreads))
+	return 0;
+
+    PyObject *seq = PySequence_Fast(repos, "Expected a sequence of repos.");
+    if (seq == NULL)
+	return NULL;
+    int nrepos = PySequence_Fast_GET_SIZE(seq);
+    HyRepo *crepos = PyMem_New(HyRepo, nrepos);
+    if (crepos == NULL) {
+	Py_DECREF(seq);
+	return PyErr_NoMemory();
+    }
+    for (int i = 0; i < nrepos; ++i) {
+	if (!repo_converter(PySequence_Fast_GET_ITEM(seq, i), crepos + i)) {
+	    PyMem_Free(crepos);
+	    Py_DECREF(seq);
+	    return NULL;
+	}
+    }
+
+    int flags = 0;
+    int ret = 0;
+    if (build_cache)
+	flags |= HY_BUILD_CACHE;
+    if (load_filelists)
+	flags |= HY_LOAD_FILELISTS;
+    if (load_presto)
+	flags |= HY_LOAD_PRESTO;
+    if (load_updateinfo)
+        flags |= HY_LOAD_UPDATEINFO;
+    Py_BEGIN_ALLOW_THREADS;
+    if (hy_sack_load_yum_repos(self->sack, crepos, nrepos, flags, nthreads))
+	ret = hy_get_errno();
+    Py_END_ALLOW_THREADS;
+    PyMem_Free(crepos);
+    Py_DECREF(seq);
+    if (ret2e(ret, "Can not load Yum repo."))
+	return NULL;
+    Py_RETURN_NONE;
+}
+
 static Py_ssize_t
 len(_SackObject *self)
 {
@@ -493,16 +619,24 @@ PyMethodDef sack_methods[] = {
      NULL},
     {"add_includes", (PyCFunction)add_includes, METH_O,
      NULL},
+    {"begin_edit", (PyCFunction)begin_edit, METH_NOARGS,
+     NULL},
+    {"end_edit", (PyCFunction)end_edit, METH_NOARGS,
+     NULL},
     {"disable_repo", (PyCFunction)disable_repo, METH_O,
      NULL},
     {"enable_repo", (PyCFunction)enable_repo, METH_O,
      NULL},
+    {"freeze", (PyCFunction)freeze, METH_NOARGS,
+     NULL},
     {"list_arches", (PyCFunction)list_arches, METH_NOARGS,
      NULL},
     {"load_system_repo", (PyCFunction)load_system_repo,
      METH_VARARGS | METH_KEYWORDS, NULL},
     {"load_yum_repo", (PyCFunction)load_yum_repo, METH_VARARGS | METH_KEYWORDS,
      NULL},
+    {"load_yum_repos", (PyCFunction)load_yum_repos,
+     METH_VARARGS | METH_KEYWORDS, NULL},
     {NULL}                      /* sentinel */
 };
 
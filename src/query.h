@@ -29,7 +29,8 @@ extern "C" {
 #include "types.h"
 
 enum _hy_query_flags {
-    HY_IGNORE_EXCLUDES	= 1 << 0
+    HY_IGNORE_EXCLUDES	= 1 << 0,
+    HY_NO_OPTIMIZE	= 1 << 1	/* apply filters in the order given */
 };
 
 HyQuery hy_query_create(HySack sack);
@@ -86,6 +87,7 @@ void hy_query_filter_latest_per_arch(HyQuery q, int val);
 void hy_query_filter_latest(HyQuery q, int val);
 
 HyPackageList hy_query_run(HyQuery q);
+HyPackageList hy_query_run_packed(HyQuery q);
 HyPackageSet hy_query_run_set(HyQuery q);
 
 
@@ -48,6 +48,7 @@ struct _Filter {
     int match_type;
     union _Match *matches;
     int nmatches;
+    int *nrefs;			/* filters sharing the matches, NULL if none */
 };
 
 struct _HyQuery {
@@ -56,6 +57,8 @@ struct _HyQuery {
     Map *result;
     struct _Filter *filters;
     int nfilters;
+    int napplied; /* filters already applied to the result */
+    unsigned generation; /* of the sack when the result was computed */
     int downgradable; /* 1 for "only downgradable installed packages" */
     int downgrades; /* 1 for "only downgrades for installed packages" */
     int updatable; /* 1 for "only updatable installed packages" */
@@ -69,5 +72,9 @@ void filter_reinit(struct _Filter *f, int nmatches);
 void filter_free(struct _Filter *f);
 
 static inline HySack query_sack(HyQuery query) { return query->sack; }
+static inline int query_evaluated(HyQuery query)
+{
+    return query->result && query->napplied == query->nfilters;
+}
 
 #endif // HY_QUERY_INTERNAL_H
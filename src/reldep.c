@@ -67,19 +67,30 @@ HyReldep
 hy_reldep_create(HySack sack, const char *name, int cmp_type, const char *evr)
 {
     Pool *pool = sack_pool(sack);
-    Id id = pool_str2id(pool, name, 0);
-
-    if (id == STRID_NULL || id == STRID_EMPTY)
-	// stop right there, this will never match anything.
-	return NULL;
+    /* new strings and relations grow the pool under the queries of a frozen
+       sack */
+    int frozen = sack_frozen(sack);
+    if (frozen)
+	sack_frozen_lock(sack, 1);
 
-    if (evr) {
-	assert(cmp_type);
-        Id ievr = pool_str2id(pool, evr, 1);
-        int flags = cmptype2relflags(cmp_type);
-        id = pool_rel2id(pool, id, ievr, flags, 1);
+    HyReldep reldep = NULL;
+    Id id = pool_str2id(pool, name, 0);
+    // stop right there if this will never match anything.
+    if (id != STRID_NULL && id != STRID_EMPTY) {
+	if (evr) {
+	    assert(cmp_type);
+	    Id ievr = pool_str2id(pool, evr, 1);
+	    int flags = cmptype2relflags(cmp_type);
+	    id = pool_rel2id(pool, id, ievr, flags, 1);
+	}
+	if (frozen)
+	    pool_whatprovides(pool, id);
+	reldep = reldep_create(pool, id);
     }
-    return reldep_create(pool, id);
+
+    if (frozen)
+	sack_frozen_unlock(sack);
+    return reldep;
 }
 
 void
@@ -21,6 +21,7 @@
 #define _GNU_SOURCE
 #include <assert.h>
 #include <errno.h>
+#include <pthread.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -60,6 +61,98 @@
 #define DEFAULT_CACHE_ROOT "/var/cache/hawkey"
 #define DEFAULT_CACHE_USER "/var/tmp/hawkey"
 
+/* metadata of a yum repo parsed into a private Pool by a worker thread of
+   hy_sack_load_yum_repos(), kept as in-memory .solv images. an image is NULL
+   if the cache can be used or the parsing failed, the metadata is then
+   loaded the usual way. */
+struct _ParsedRepo {
+    HySack sack;
+    HyRepo hrepo;
+    int flags;
+    char *main;
+    size_t main_len;
+    /* filelists and presto, updateinfo is never parsed ahead */
+    char *ext[_HY_REPODATA_UPDATEINFO];
+    size_t ext_len[_HY_REPODATA_UPDATEINFO];
+};
+
+/* queries on a frozen sack hold 'frozen' shared, growing its pool takes it
+   exclusively. 'tmpspace' guards the pool's temporary string space on the
+   query paths, 'query_cache' the cached query results, 'nevras' the NEVRA
+   strings, 'solver_cache' the idle solvers, 'log' the log file, 'workers'
+   the query worker threads */
+struct _SackLocks {
+    pthread_rwlock_t frozen;
+    pthread_mutex_t tmpspace;
+    pthread_mutex_t query_cache;
+    pthread_mutex_t nevras;
+    pthread_mutex_t solver_cache;
+    pthread_mutex_t log;
+    pthread_mutex_t workers;
+};
+
+/* the size of the blocks holding the NEVRA strings, a longer string gets a
+   block of its own */
+#define NEVRA_BLOCK 65536
+
+/* results of the recent queries, see hy_sack_set_query_cache_size() */
+struct _QueryCacheEntry {
+    unsigned char *key;
+    int keylen;
+    unsigned hash;
+    Map result;
+    unsigned long used;		/* tick of the last use, 0 for a free entry */
+};
+
+struct _QueryCache {
+    struct _QueryCacheEntry *entries;
+    int nentries;
+    unsigned long tick;
+    /* the state of the sack the entries were computed in */
+    unsigned generation;
+    int nsolvables;
+    Repo *installed;
+    unsigned long hits;
+    unsigned long misses;
+};
+
+/* NEVRA strings of the solvables, see sack_get_nevra(). the blocks are never
+   reallocated so the strings stay put until the cache is flushed */
+struct _NevraCache {
+    const char **nevras;	/* per solvable Id, NULL if not built yet */
+    int nnevras;
+    char **blocks;
+    int nblocks;
+    int block_left;		/* free bytes at the end of the last block */
+};
+
+/* solvers of finished goals, see hy_sack_set_solver_cache_size() */
+struct _SolverCache {
+    Solver **solvers;
+    int nsolvers;
+    int size;
+    /* the pool state the solvers were created for */
+    int nsolvables;
+    Repo *installed;
+};
+
+/* threads helping queries with their scans, see sack_run_workers(). they are
+   started on the first use and kept until the sack is freed or the number of
+   query threads changes */
+struct _Workers {
+    pthread_mutex_t *lock;	/* the sack's 'workers' lock */
+    pthread_cond_t wake;	/* a job was posted or the workers should quit */
+    pthread_cond_t done;	/* the last worker finished the job */
+    pthread_t *threads;
+    int nthreads;
+    int busy;			/* a job is being run */
+    unsigned job;		/* bumped for every job */
+    int running;		/* workers still running the job */
+    int quit;
+    void (*fn)(void *);
+    void *arg;
+};
+
 static int
 current_rpmdb_checksum(Pool *pool, unsigned char csout[CHKSUM_BYTES])
 {
@@ -120,15 +213,386 @@ free_map_fully(Map *m)
     return NULL;
 }
 
+static struct _EvrIndex *
+evr_index_free(struct _EvrIndex *idx)
+{
+    if (idx) {
+	solv_free(idx->epochs);
+	solv_free(idx->versions);
+	solv_free(idx->releases);
+	solv_free(idx->vids);
+	solv_free(idx->rids);
+	solv_free(idx);
+    }
+    return NULL;
+}
+
+static struct _NameIndex *
+name_index_free(struct _NameIndex *idx)
+{
+    if (idx) {
+	solv_free(idx->names);
+	solv_free(idx->starts);
+	solv_free(idx->solvables);
+	solv_free(idx);
+    }
+    return NULL;
+}
+
+static struct _RevdepIndex *
+revdep_index_free(struct _RevdepIndex *idx)
+{
+    if (idx) {
+	solv_free(idx->heads);
+	solv_free(idx->entries);
+	solv_free(idx);
+    }
+    return NULL;
+}
+
+static struct _InstalledIndex *
+installed_index_free(struct _InstalledIndex *idx)
+{
+    if (idx) {
+	solv_free(idx->heads);
+	solv_free(idx->entries);
+	solv_free(idx);
+    }
+    return NULL;
+}
+
+static void
+query_cache_flush(struct _QueryCache *cache)
+{
+    for (int i = 0; i < cache->nentries; ++i) {
+	struct _QueryCacheEntry *e = cache->entries + i;
+	if (!e->used)
+	    continue;
+	solv_free(e->key);
+	map_free(&e->result);
+	memset(e, 0, sizeof(*e));
+    }
+}
+
+static struct _QueryCache *
+query_cache_free(struct _QueryCache *cache)
+{
+    if (cache) {
+	query_cache_flush(cache);
+	solv_free(cache->entries);
+	solv_free(cache);
+    }
+    return NULL;
+}
+
+/* the entries are only good for the sack state they were computed in */
+static void
+query_cache_validate(HySack sack, struct _QueryCache *cache)
+{
+    Pool *pool = sack_pool(sack);
+
+    if (cache->generation == sack->generation &&
+	cache->nsolvables == pool->nsolvables &&
+	cache->installed == pool->installed)
+	return;
+    query_cache_flush(cache);
+    cache->generation = sack->generation;
+    cache->nsolvables = pool->nsolvables;
+    cache->installed = pool->installed;
+}
+
+static unsigned
+query_cache_hash(const unsigned char *key, int keylen)
+{
+    // FNV-1a
+    unsigned h = 2166136261u;
+    for (int i = 0; i < keylen; ++i)
+	h = (h ^ key[i]) * 16777619u;
+    return h;
+}
+
+static struct _QueryCacheEntry *
+query_cache_find(struct _QueryCache *cache, const unsigned char *key,
+		 int keylen, unsigned hash)
+{
+    for (int i = 0; i < cache->nentries; ++i) {
+	struct _QueryCacheEntry *e = cache->entries + i;
+	if (e->used && e->hash == hash && e->keylen == keylen &&
+	    !memcmp(e->key, key, keylen))
+	    return e;
+    }
+    return NULL;
+}
+
+static struct _NevraCache *
+nevra_cache_free(struct _NevraCache *cache)
+{
+    if (cache) {
+	for (int i = 0; i < cache->nblocks; ++i)
+	    solv_free(cache->blocks[i]);
+	solv_free(cache->blocks);
+	solv_free(cache->nevras);
+	solv_free(cache);
+    }
+    return NULL;
+}
+
+/* 'len' bytes in the cache's blocks */
+static char *
+nevra_cache_alloc(struct _NevraCache *cache, int len)
+{
+    if (len > cache->block_left) {
+	int size = len > NEVRA_BLOCK ? len : NEVRA_BLOCK;
+	cache->blocks = solv_extend(cache->blocks, cache->nblocks, 1,
+				    sizeof(char *), 15);
+	cache->blocks[cache->nblocks++] = solv_malloc(size);
+	cache->block_left = size;
+    }
+    cache->block_left -= len;
+    return cache->blocks[cache->nblocks - 1] + cache->block_left;
+}
+
+/* like pool_solvable2str(), but into the cache instead of the pool's
+   temporary space */
+static const char *
+nevra_cache_add(struct _NevraCache *cache, Pool *pool, Solvable *s)
+{
+    const char *n = pool_id2str(pool, s->name);
+    const char *e = s->evr ? pool_id2str(pool, s->evr) : "";
+    const char *a = s->arch ? pool_id2str(pool, s->arch) : "";
+    int nlen = strlen(n), elen = strlen(e), alen = strlen(a);
+    char *nevra = nevra_cache_alloc(cache, nlen + (elen ? elen + 1 : 0) +
+				    (alen ? alen + 1 : 0) + 1);
+    char *p = nevra + nlen;
+
+    memcpy(nevra, n, nlen);
+    if (elen) {
+	*p++ = '-';
+	memcpy(p, e, elen);
+	p += elen;
+    }
+    if (alen) {
+	*p++ = '.';
+	memcpy(p, a, alen);
+	p += alen;
+    }
+    *p = '\0';
+    return nevra;
+}
+
+/* called whenever repos are freed, their solvable Ids get reused */
+static void
+invalidate_nevras(HySack sack)
+{
+    pthread_mutex_lock(&sack->locks->nevras);
+    sack->nevra_cache = nevra_cache_free(sack->nevra_cache);
+    pthread_mutex_unlock(&sack->locks->nevras);
+}
+
+static void
+solver_cache_flush(struct _SolverCache *cache)
+{
+    for (int i = 0; i < cache->nsolvers; ++i)
+	solver_free(cache->solvers[i]);
+    cache->nsolvers = 0;
+}
+
+static struct _SolverCache *
+solver_cache_free(struct _SolverCache *cache)
+{
+    if (cache) {
+	solver_cache_flush(cache);
+	solv_free(cache->solvers);
+	solv_free(cache);
+    }
+    return NULL;
+}
+
+/* a solver is sized for the solvables of the pool it was created in */
+static void
+solver_cache_validate(HySack sack, struct _SolverCache *cache)
+{
+    Pool *pool = sack_pool(sack);
+
+    if (cache->nsolvables == pool->nsolvables &&
+	cache->installed == pool->installed)
+	return;
+    solver_cache_flush(cache);
+    cache->nsolvables = pool->nsolvables;
+    cache->installed = pool->installed;
+}
+
+static void *
+worker_main(void *data)
+{
+    struct _Workers *workers = data;
+    unsigned seen = 0;
+
+    pthread_mutex_lock(workers->lock);
+    while (1) {
+	while (!workers->quit && workers->job == seen)
+	    pthread_cond_wait(&workers->wake, workers->lock);
+	if (workers->quit)
+	    break;
+	seen = workers->job;
+	pthread_mutex_unlock(workers->lock);
+	workers->fn(workers->arg);
+	pthread_mutex_lock(workers->lock);
+	if (--workers->running == 0)
+	    pthread_cond_signal(&workers->done);
+    }
+    pthread_mutex_unlock(workers->lock);
+    return NULL;
+}
+
+/* called with the 'workers' lock held */
+static struct _Workers *
+workers_create(pthread_mutex_t *lock, int nthreads)
+{
+    struct _Workers *workers = solv_calloc(1, sizeof(*workers));
+
+    workers->lock = lock;
+    pthread_cond_init(&workers->wake, NULL);
+    pthread_cond_init(&workers->done, NULL);
+    workers->threads = solv_calloc(nthreads > 0 ? nthreads : 1,
+				   sizeof(pthread_t));
+    while (workers->nthreads < nthreads &&
+	   !pthread_create(workers->threads + workers->nthreads, NULL,
+			   worker_main, workers))
+	workers->nthreads++;
+    return workers;
+}
+
+static void
+workers_stop(HySack sack)
+{
+    struct _Workers *workers = sack->workers;
+
+    if (workers == NULL)
+	return;
+    pthread_mutex_lock(workers->lock);
+    workers->quit = 1;
+    pthread_cond_broadcast(&workers->wake);
+    pthread_mutex_unlock(workers->lock);
+    for (int i = 0; i < workers->nthreads; ++i)
+	pthread_join(workers->threads[i], NULL);
+    pthread_cond_destroy(&workers->wake);
+    pthread_cond_destroy(&workers->done);
+    solv_free(workers->threads);
+    solv_free(workers);
+    sack->workers = NULL;
+}
+
+/* run 'fn' in the calling thread and in each of the sack's query_threads - 1
+   worker threads, returning once all of them are done. 'fn' has to split the
+   work up itself, if another query is using the workers at the time it only
+   runs in the calling thread. */
+void
+sack_run_workers(HySack sack, void (*fn)(void *), void *arg)
+{
+    struct _Workers *workers;
+
+    pthread_mutex_lock(&sack->locks->workers);
+    if (sack->workers == NULL)
+	sack->workers = workers_create(&sack->locks->workers,
+				       sack->query_threads - 1);
+    workers = sack->workers;
+    if (workers->busy || workers->nthreads == 0) {
+	pthread_mutex_unlock(&sack->locks->workers);
+	fn(arg);
+	return;
+    }
+    workers->busy = 1;
+    workers->fn = fn;
+    workers->arg = arg;
+    workers->running = workers->nthreads;
+    workers->job++;
+    pthread_cond_broadcast(&workers->wake);
+    pthread_mutex_unlock(&sack->locks->workers);
+
+    fn(arg);
+
+    pthread_mutex_lock(&sack->locks->workers);
+    while (workers->running)
+	pthread_cond_wait(&workers->done, &sack->locks->workers);
+    workers->busy = 0;
+    pthread_mutex_unlock(&sack->locks->workers);
+}
+
+static void
+free_repo(HySack sack, Repo *repo)
+{
+    invalidate_nevras(sack);
+    pthread_mutex_lock(&sack->locks->solver_cache);
+    if (sack->solver_cache)
+	solver_cache_flush(sack->solver_cache);
+    pthread_mutex_unlock(&sack->locks->solver_cache);
+    repo_free(repo, 1);
+}
+
+/* called whenever solvables are added to the pool. the revdep index is only
+   ever extended, see sack_make_revdep_index_ready(). */
+static void
+invalidate_indexes(HySack sack)
+{
+    sack->provides_ready = 0;
+    sack->generation++;
+    sack->evr_index = evr_index_free(sack->evr_index);
+    sack->name_index = name_index_free(sack->name_index);
+    sack->installed_index = installed_index_free(sack->installed_index);
+}
+
+/* called whenever the set of packages queries consider changes */
+static void
+invalidate_considered(HySack sack)
+{
+    sack->considered_uptodate = 0;
+    sack->generation++;
+}
+
+static int
+map_tst_bounded(Map *m, Id p)
+{
+    return p < m->size << 3 && MAPTST(m, p);
+}
+
+/* pool->considered if a change of the excludes, includes or enabled repos can
+   be applied to it in place, NULL if it has to be recomputed */
+static Map *
+considered_for_update(HySack sack)
+{
+    Pool *pool = sack_pool(sack);
+    Map *considered = pool->considered;
+
+    if (sack->edit_depth || !sack->considered_uptodate || considered == NULL ||
+	considered->size < (pool->nsolvables + 7) >> 3)
+	return NULL;
+    return considered;
+}
+
+/* the considered map was changed in place and is still up to date. the
+   pool's providers do not depend on it, so excludes and includes keep the
+   sack frozen. the caller holds the frozen lock exclusively if the sack is
+   frozen. */
+static void
+update_considered(HySack sack)
+{
+    sack->generation++;
+}
+
 void
 sack_recompute_considered(HySack sack)
 {
     Pool *pool = sack_pool(sack);
     if (sack->considered_uptodate)
 	return;
+    sack->frozen = 0;
     if (!pool->considered) {
-	if (!sack->repo_excludes && !sack->pkg_excludes)
+	if (!sack->repo_excludes && !sack->pkg_excludes) {
+	    // nothing to exclude, everything is considered
+	    sack->considered_uptodate = 1;
 	    return;
+	}
 	pool->considered = solv_calloc(1, sizeof(Map));
 	map_init(pool->considered, pool->nsolvables);
     } else
@@ -184,35 +648,44 @@ setarch(HySack sack, const char *req_arch)
 }
 
 static void
-log_cb(Pool *pool, void *cb_data, int level, const char *buf)
+log_line(FILE *out, int level, const char *buf)
 {
-    HySack sack = cb_data;
-
-    if (sack->log_out == NULL) {
-	const char *fn = sack->log_file;
-
-	if (!sack->log_file)
-	    fn = pool_tmpjoin(pool, sack->cache_dir, "/hawkey.log", NULL);
-
-	sack->log_out = fopen(fn, "a");
-	if (sack->log_out)
-	    HY_LOG_INFO("Started hawkey-%d.%d.%d.", HY_VERSION_MAJOR,
-			HY_VERSION_MINOR, HY_VERSION_PATCH);
-    }
-    if (!sack->log_out)
-	return;
-
     time_t t = time(NULL);
     struct tm tm;
     char timestr[26];
 
     localtime_r(&t, &tm);
     strftime(timestr, 26, "%b-%d %H:%M:%S ", &tm);
-    const char *pref = pool_tmpjoin(pool, ll_name(level), " ", timestr);
-    pref = pool_tmpjoin(pool, pref, buf, NULL);
+    fprintf(out, "%s %s%s", ll_name(level), timestr, buf);
+    fflush(out);
+}
+
+/* the solvers of hy_goal_run_batch() log from several threads at once: the
+   lines are written under the 'log' lock and without the pool's temporary
+   space */
+static void
+log_cb(Pool *pool, void *cb_data, int level, const char *buf)
+{
+    HySack sack = cb_data;
+
+    pthread_mutex_lock(&sack->locks->log);
+    if (sack->log_out == NULL) {
+	char *fn = sack->log_file ? solv_strdup(sack->log_file) :
+	    solv_dupjoin(sack->cache_dir, "/hawkey.log", NULL);
+
+	sack->log_out = fopen(fn, "a");
+	solv_free(fn);
+	if (sack->log_out) {
+	    char started[64];
 
-    fwrite(pref, strlen(pref), 1, sack->log_out);
-    fflush(sack->log_out);
+	    snprintf(started, sizeof(started), "Started hawkey-%d.%d.%d.\n",
+		     HY_VERSION_MAJOR, HY_VERSION_MINOR, HY_VERSION_PATCH);
+	    log_line(sack->log_out, HY_LL_INFO, started);
+	}
+    }
+    if (sack->log_out)
+	log_line(sack->log_out, level, buf);
+    pthread_mutex_unlock(&sack->locks->log);
 }
 
 static void
@@ -294,7 +767,7 @@ queue_filter_version(HySack sack, Queue *queue, const char *version)
 static int
 load_ext(HySack sack, HyRepo hrepo, int which_repodata,
 	 const char *suffix, int which_filename,
-	 int (*cb)(Repo *, FILE *))
+	 int (*cb)(Repo *, FILE *), struct _ParsedRepo *parsed)
 {
     int ret = 0;
     Repo *repo = hrepo->libsolv_repo;
@@ -320,6 +793,9 @@ load_ext(HySack sack, HyRepo hrepo, int which_repodata,
 	if (which_repodata == _HY_REPODATA_FILENAMES)
 	    flags |= REPO_LOCALPOOL;
 	done = 1;
+	/* read whole: repo_add_solv() copies the strings and id arrays into
+	   the pool and the repodata, a mapping of the file could not back
+	   them */
 	HY_LOG_INFO("%s: using cache file: %s", __func__, fn_cache);
 	ret = repo_add_solv(repo, fp, flags);
 	assert(ret == 0);
@@ -336,18 +812,28 @@ load_ext(HySack sack, HyRepo hrepo, int which_repodata,
     if (done)
 	goto finish;
 
-    fp = solv_xfopen(fn, "r");
-    if (fp == NULL) {
-	HY_LOG_ERROR(format_err_str("Failed to open: %s.", fn));
-	ret = HY_E_IO;
-	goto finish;
-    }
-    HY_LOG_INFO("%s: loading: %s", __func__, fn);
-
     int previous_last = repo->nrepodata - 1;
-    ret = cb(repo, fp);
-    fclose(fp);
-    assert(ret == 0);
+    if (parsed && which_repodata < _HY_REPODATA_UPDATEINFO &&
+	parsed->ext[which_repodata]) {
+	fp = fmemopen(parsed->ext[which_repodata],
+		      parsed->ext_len[which_repodata], "r");
+	HY_LOG_INFO("%s: loading parsed: %s", __func__, fn);
+	ret = HY_E_LIBSOLV;
+	if (fp && !repo_add_solv(repo, fp, REPO_EXTEND_SOLVABLES))
+	    ret = 0;
+    } else {
+	fp = solv_xfopen(fn, "r");
+	if (fp == NULL) {
+	    HY_LOG_ERROR(format_err_str("Failed to open: %s.", fn));
+	    ret = HY_E_IO;
+	    goto finish;
+	}
+	HY_LOG_INFO("%s: loading: %s", __func__, fn);
+	ret = cb(repo, fp);
+	assert(ret == 0);
+    }
+    if (fp)
+	fclose(fp);
     if (ret == 0) {
 	repo_update_state(hrepo, which_repodata, _HY_LOADED_FETCH);
 	assert(previous_last == repo->nrepodata - 2); (void)previous_last;
@@ -357,7 +843,7 @@ load_ext(HySack sack, HyRepo hrepo, int which_repodata,
     if (ret)
 	HY_LOG_ERROR("load_ext(...%d....) has failed: %d", which_repodata, ret);
 
-    sack->provides_ready = 0;
+    invalidate_indexes(sack);
     return ret;
 }
 
@@ -544,7 +1030,7 @@ write_ext(HySack sack, HyRepo hrepo, int which_repodata, const char *suffix)
 }
 
 static int
-load_yum_repo(HySack sack, HyRepo hrepo)
+load_yum_repo(HySack sack, HyRepo hrepo, struct _ParsedRepo *parsed)
 {
     int retval = 0;
     Pool *pool = sack->pool;
@@ -574,6 +1060,19 @@ load_yum_repo(HySack sack, HyRepo hrepo)
 	    goto finish;
 	}
 	hrepo->state_main = _HY_LOADED_CACHE;
+    } else if (parsed && parsed->main) {
+	FILE *fp_parsed = fmemopen(parsed->main, parsed->main_len, "r");
+
+	HY_LOG_INFO("fetching parsed %s", name);
+	retval = fp_parsed == NULL || repo_add_solv(repo, fp_parsed, 0);
+	if (fp_parsed)
+	    fclose(fp_parsed);
+	if (retval) {
+	    HY_LOG_ERROR("repo_add_solv() has failed.");
+	    retval = HY_E_LIBSOLV;
+	    goto finish;
+	}
+	hrepo->state_main = _HY_LOADED_FETCH;
     } else {
 	fp_primary = solv_xfopen(hy_repo_get_string(hrepo, HY_REPO_PRIMARY_FN),
 				 "r");
@@ -600,12 +1099,159 @@ load_yum_repo(HySack sack, HyRepo hrepo)
 
     if (retval == 0) {
 	repo_finalize_init(hrepo, repo);
-	sack->provides_ready = 0;
+	invalidate_indexes(sack);
     } else
-	repo_free(repo, 1);
+	free_repo(sack, repo);
     return retval;
 }
 
+static const struct {
+    int load_flag;
+    int which_filename;
+    const char *suffix;
+    int (*cb)(Repo *, FILE *);
+} parsed_exts[] = {
+    [_HY_REPODATA_FILENAMES] = {HY_LOAD_FILELISTS, HY_REPO_FILELISTS_FN,
+				HY_EXT_FILENAMES, load_filelists_cb},
+    [_HY_REPODATA_PRESTO] = {HY_LOAD_PRESTO, HY_REPO_PRESTO_FN,
+			     HY_EXT_PRESTO, load_presto_cb},
+};
+
+static int
+cache_is_valid(HySack sack, const char *name, const char *suffix,
+	       unsigned char checksum[CHKSUM_BYTES])
+{
+    char *fn_cache = hy_sack_give_cache_fn(sack, name, suffix);
+    FILE *fp = fopen(fn_cache, "r");
+    int valid = can_use_repomd_cache(fp, checksum);
+
+    if (fp)
+	fclose(fp);
+    solv_free(fn_cache);
+    return valid;
+}
+
+/* write the whole 'repo' or just 'data' if not NULL into a malloc()ed image */
+static char *
+write_image(Repo *repo, Repodata *data, size_t *len)
+{
+    char *image = NULL;
+    FILE *fp = open_memstream(&image, len);
+    int ret;
+
+    if (fp == NULL)
+	return NULL;
+    ret = data ? repodata_write(data, fp) : repo_write(repo, fp);
+    ret |= fclose(fp);
+    if (ret) {
+	free(image);
+	return NULL;
+    }
+    return image;
+}
+
+/* runs on a worker thread: must not touch the sack's Pool, nor log */
+static void
+parse_yum_repo(struct _ParsedRepo *parsed)
+{
+    HySack sack = parsed->sack;
+    HyRepo hrepo = parsed->hrepo;
+    const char *name = hy_repo_get_string(hrepo, HY_REPO_NAME);
+    unsigned char checksum[CHKSUM_BYTES];
+    int parse_ext[_HY_REPODATA_UPDATEINFO];
+    int parse_main, ret;
+    FILE *fp_repomd, *fp;
+
+    fp_repomd = fopen(hy_repo_get_string(hrepo, HY_REPO_MD_FN), "r");
+    if (fp_repomd == NULL)
+	return;
+    checksum_fp(checksum, fp_repomd);
+
+    /* find out what is not cached */
+    parse_main = !cache_is_valid(sack, name, NULL, checksum);
+    ret = parse_main;
+    for (int which = 0; which < _HY_REPODATA_UPDATEINFO; ++which) {
+	parse_ext[which] =
+	    parsed->flags & parsed_exts[which].load_flag &&
+	    hy_repo_get_string(hrepo, parsed_exts[which].which_filename) &&
+	    !cache_is_valid(sack, name, parsed_exts[which].suffix, checksum);
+	ret |= parse_ext[which];
+    }
+    if (!ret) {
+	fclose(fp_repomd);
+	return;
+    }
+
+    Pool *pool = pool_create();
+    Repo *repo = repo_create(pool, name);
+
+    if (parse_main) {
+	const char *fn_primary = hy_repo_get_string(hrepo, HY_REPO_PRIMARY_FN);
+	fp = fn_primary ? solv_xfopen(fn_primary, "r") : NULL;
+	ret = fp == NULL || repo_add_repomdxml(repo, fp_repomd, 0) ||
+	    repo_add_rpmmd(repo, fp, 0, 0);
+	if (!ret)
+	    parsed->main = write_image(repo, NULL, &parsed->main_len);
+    } else {
+	/* the extensions need the cached packages to extend */
+	char *fn_cache = hy_sack_give_cache_fn(sack, name, NULL);
+	fp = fopen(fn_cache, "r");
+	ret = fp == NULL || repo_add_solv(repo, fp, 0);
+	solv_free(fn_cache);
+    }
+    if (fp)
+	fclose(fp);
+    fclose(fp_repomd);
+
+    for (int which = 0; which < _HY_REPODATA_UPDATEINFO && !ret; ++which) {
+	if (!parse_ext[which])
+	    continue;
+	fp = solv_xfopen(hy_repo_get_string(hrepo,
+					    parsed_exts[which].which_filename),
+			 "r");
+	if (fp == NULL)
+	    continue;
+	int previous_last = repo->nrepodata - 1;
+	if (!parsed_exts[which].cb(repo, fp) &&
+	    repo->nrepodata - 1 > previous_last) {
+	    Repodata *data = repo_id2repodata(repo, repo->nrepodata - 1);
+	    parsed->ext[which] = write_image(repo, data, parsed->ext_len + which);
+	}
+	fclose(fp);
+    }
+    pool_free(pool);
+}
+
+struct _ParseQueue {
+    struct _ParsedRepo *parsed;
+    int nparsed;
+    int next;
+    pthread_mutex_t lock;
+};
+
+static void *
+parse_worker(void *data)
+{
+    struct _ParseQueue *queue = data;
+
+    while (1) {
+	pthread_mutex_lock(&queue->lock);
+	int i = queue->next++;
+	pthread_mutex_unlock(&queue->lock);
+	if (i >= queue->nparsed)
+	    return NULL;
+	parse_yum_repo(queue->parsed + i);
+    }
+}
+
+static void
+parsed_repo_free(struct _ParsedRepo *parsed)
+{
+    free(parsed->main);
+    for (int which = 0; which < _HY_REPODATA_UPDATEINFO; ++which)
+	free(parsed->ext[which]);
+}
+
 /**
  * Creates a new package sack, the fundamental hawkey structure.
  *
@@ -628,6 +1274,15 @@ hy_sack_create(const char *cache_path, const char *arch, const char *rootdir,
     sack->running_kernel_fn = running_kernel;
     sack->considered_uptodate = 1;
     sack->cmdline_repo_created = 0;
+    sack->locks = solv_calloc(1, sizeof(*sack->locks));
+    pthread_rwlock_init(&sack->locks->frozen, NULL);
+    pthread_mutex_init(&sack->locks->tmpspace, NULL);
+    pthread_mutex_init(&sack->locks->query_cache, NULL);
+    pthread_mutex_init(&sack->locks->nevras, NULL);
+    pthread_mutex_init(&sack->locks->solver_cache, NULL);
+    pthread_mutex_init(&sack->locks->log, NULL);
+    pthread_mutex_init(&sack->locks->workers, NULL);
+    sack->scan_chunk = SCAN_CHUNK;
     if (log_file)
 	sack->log_file = solv_strdup(log_file);
 
@@ -694,6 +1349,22 @@ hy_sack_free(HySack sack)
     free_map_fully(sack->pkg_includes);
     free_map_fully(sack->repo_excludes);
     free_map_fully(pool->considered);
+    evr_index_free(sack->evr_index);
+    name_index_free(sack->name_index);
+    revdep_index_free(sack->revdep_index);
+    installed_index_free(sack->installed_index);
+    query_cache_free(sack->query_cache);
+    nevra_cache_free(sack->nevra_cache);
+    solver_cache_free(sack->solver_cache);
+    workers_stop(sack);
+    pthread_rwlock_destroy(&sack->locks->frozen);
+    pthread_mutex_destroy(&sack->locks->tmpspace);
+    pthread_mutex_destroy(&sack->locks->query_cache);
+    pthread_mutex_destroy(&sack->locks->nevras);
+    pthread_mutex_destroy(&sack->locks->solver_cache);
+    pthread_mutex_destroy(&sack->locks->log);
+    pthread_mutex_destroy(&sack->locks->workers);
+    solv_free(sack->locks);
     pool_free(sack->pool);
     solv_free(sack);
 }
@@ -769,6 +1440,84 @@ hy_sack_set_installonly_limit(HySack sack, int limit)
     sack->installonly_limit = limit;
 }
 
+/**
+ * Let queries split their per-package scans among up to 'nthreads' threads.
+ *
+ * Only pays off with large sacks, 1 (the default) scans in the calling
+ * thread. The helper threads are started by the first scan that uses them
+ * and then kept for later queries.
+ */
+void
+hy_sack_set_query_threads(HySack sack, int nthreads)
+{
+    workers_stop(sack);
+    sack->query_threads = nthreads;
+}
+
+/**
+ * Keep the results of up to 'nentries' recent queries.
+ *
+ * A query with the same flags and filters as a cached one, in any order,
+ * then gets a copy of its result. The cache is dropped whenever repos are
+ * loaded, enabled or disabled and when the excludes or includes change. 0
+ * (the default) disables it. Resets the hit and miss counters.
+ */
+void
+hy_sack_set_query_cache_size(HySack sack, int nentries)
+{
+    pthread_mutex_lock(&sack->locks->query_cache);
+    sack->query_cache = query_cache_free(sack->query_cache);
+    if (nentries > 0) {
+	struct _QueryCache *cache = solv_calloc(1, sizeof(*cache));
+	cache->entries = solv_calloc(nentries, sizeof(*cache->entries));
+	cache->nentries = nentries;
+	sack->query_cache = cache;
+    }
+    pthread_mutex_unlock(&sack->locks->query_cache);
+}
+
+/**
+ * Keep up to 'nsolvers' solvers of freed or re-run goals for the next goals
+ * to solve in, instead of creating a solver for every run. This pays off
+ * when many goals are solved against the same packages. The solvers are
+ * dropped whenever packages are added or removed. The default 0 disables it.
+ */
+void
+hy_sack_set_solver_cache_size(HySack sack, int nsolvers)
+{
+    pthread_mutex_lock(&sack->locks->solver_cache);
+    sack->solver_cache = solver_cache_free(sack->solver_cache);
+    if (nsolvers > 0) {
+	struct _SolverCache *cache = solv_calloc(1, sizeof(*cache));
+	cache->solvers = solv_calloc(nsolvers, sizeof(Solver *));
+	cache->size = nsolvers;
+	sack->solver_cache = cache;
+    }
+    pthread_mutex_unlock(&sack->locks->solver_cache);
+}
+
+unsigned long
+hy_sack_get_query_cache_hits(HySack sack)
+{
+    unsigned long n;
+
+    pthread_mutex_lock(&sack->locks->query_cache);
+    n = sack->query_cache ? sack->query_cache->hits : 0;
+    pthread_mutex_unlock(&sack->locks->query_cache);
+    return n;
+}
+
+unsigned long
+hy_sack_get_query_cache_misses(HySack sack)
+{
+    unsigned long n;
+
+    pthread_mutex_lock(&sack->locks->query_cache);
+    n = sack->query_cache ? sack->query_cache->misses : 0;
+    pthread_mutex_unlock(&sack->locks->query_cache);
+    return n;
+}
+
 /**
  * Creates repo for command line rpms.
  *
@@ -806,7 +1555,7 @@ hy_sack_add_cmdline_package(HySack sack, const char *fn)
 	return NULL;
     }
     p = repo_add_rpm(repo, fn, REPO_REUSE_REPODATA|REPO_NO_INTERNALIZE);
-    sack->provides_ready = 0;    /* triggers internalizing later */
+    invalidate_indexes(sack);    /* triggers internalizing later */
     return package_create(sack, p);
 }
 
@@ -827,16 +1576,29 @@ hy_sack_add_excludes(HySack sack, HyPackageSet pset)
 {
     Pool *pool = sack_pool(sack);
     Map *excl = sack->pkg_excludes;
-    Map *nexcl = packageset_get_map(pset);
-
+    Map nexcl;
+    /* queries on a frozen sack read the considered map */
+    int frozen = sack_frozen(sack);
+
+    packageset_to_map(pset, &nexcl);
+    if (frozen)
+	sack_frozen_lock(sack, 1);
+    Map *considered = considered_for_update(sack);
     if (excl == NULL) {
 	excl = solv_calloc(1, sizeof(Map));
 	map_init(excl, pool->nsolvables);
 	sack->pkg_excludes = excl;
     }
-    assert(excl->size >= nexcl->size);
-    map_or(excl, nexcl);
-    sack->considered_uptodate = 0;
+    assert(excl->size >= nexcl.size);
+    map_or(excl, &nexcl);
+    if (considered) {
+	map_subtract(considered, &nexcl);
+	update_considered(sack);
+    } else
+	invalidate_considered(sack);
+    if (frozen)
+	sack_frozen_unlock(sack);
+    map_free(&nexcl);
 }
 
 void
@@ -844,16 +1606,45 @@ hy_sack_add_includes(HySack sack, HyPackageSet pset)
 {
     Pool *pool = sack_pool(sack);
     Map *incl = sack->pkg_includes;
-    Map *nincl = packageset_get_map(pset);
+    Map nincl;
+    int frozen = sack_frozen(sack);
+
+    packageset_to_map(pset, &nincl);
+    if (frozen)
+	sack_frozen_lock(sack, 1);
+    Map *considered = considered_for_update(sack);
+    if (considered) {
+	if (incl == NULL)
+	    map_and(considered, &nincl);
+	else {
+	    // the newly included packages that are not excluded otherwise
+	    Map *rexcl = sack->repo_excludes;
+	    Map *pexcl = sack->pkg_excludes;
+	    int size = nincl.size < considered->size ? nincl.size :
+						       considered->size;
+	    for (int i = 0; i < size; ++i) {
+		unsigned char bits = nincl.map[i];
+		if (rexcl && i < rexcl->size)
+		    bits &= ~rexcl->map[i];
+		if (pexcl && i < pexcl->size)
+		    bits &= ~pexcl->map[i];
+		considered->map[i] |= bits;
+	    }
+	}
+	update_considered(sack);
+    } else
+	invalidate_considered(sack);
 
     if (incl == NULL) {
 	incl = solv_calloc(1, sizeof(Map));
 	map_init(incl, pool->nsolvables);
 	sack->pkg_includes = incl;
     }
-    assert(incl->size >= nincl->size);
-    map_or(incl, nincl);
-    sack->considered_uptodate = 0;
+    assert(incl->size >= nincl.size);
+    map_or(incl, &nincl);
+    if (frozen)
+	sack_frozen_unlock(sack);
+    map_free(&nincl);
 }
 
 void
@@ -862,12 +1653,10 @@ hy_sack_set_excludes(HySack sack, HyPackageSet pset)
     sack->pkg_excludes = free_map_fully(sack->pkg_excludes);
 
     if (pset) {
-        Map *nexcl = packageset_get_map(pset);
-
 	sack->pkg_excludes = solv_calloc(1, sizeof(Map));
-	map_init_clone(sack->pkg_excludes, nexcl);
+	packageset_to_map(pset, sack->pkg_excludes);
     }
-    sack->considered_uptodate = 0;
+    invalidate_considered(sack);
 }
 
 void
@@ -876,12 +1665,10 @@ hy_sack_set_includes(HySack sack, HyPackageSet pset)
     sack->pkg_includes = free_map_fully(sack->pkg_includes);
 
     if (pset) {
-        Map *nincl = packageset_get_map(pset);
-
 	sack->pkg_includes = solv_calloc(1, sizeof(Map));
-	map_init_clone(sack->pkg_includes, nincl);
+	packageset_to_map(pset, sack->pkg_includes);
     }
-    sack->considered_uptodate = 0;
+    invalidate_considered(sack);
 }
 
 int
@@ -890,26 +1677,103 @@ hy_sack_repo_enabled(HySack sack, const char *reponame, int enabled)
     Pool *pool = sack_pool(sack);
     Repo *repo = repo_by_name(sack, reponame);
     Map *excl = sack->repo_excludes;
+    int frozen = sack_frozen(sack);
 
     if (repo == NULL)
 	return HY_E_OP;
+    if (frozen)
+	sack_frozen_lock(sack, 1);
+    Map *considered = considered_for_update(sack);
     if (excl == NULL) {
 	excl = solv_calloc(1, sizeof(Map));
 	map_init(excl, pool->nsolvables);
 	sack->repo_excludes = excl;
     }
     repo->disabled = !enabled;
+    /* the providers skip disabled repos, this thaws a frozen sack */
     sack->provides_ready = 0;
 
     Id p;
     Solvable *s;
+    Map *pexcl = sack->pkg_excludes;
+    Map *incl = sack->pkg_includes;
     if (repo->disabled)
-	FOR_REPO_SOLVABLES(repo, p, s)
+	FOR_REPO_SOLVABLES(repo, p, s) {
 	    MAPSET(sack->repo_excludes, p);
+	    if (considered)
+		MAPCLR(considered, p);
+	}
     else
-	FOR_REPO_SOLVABLES(repo, p, s)
+	FOR_REPO_SOLVABLES(repo, p, s) {
 	    MAPCLR(sack->repo_excludes, p);
-    sack->considered_uptodate = 0;
+	    if (considered && !(pexcl && map_tst_bounded(pexcl, p)) &&
+		(!incl || map_tst_bounded(incl, p)))
+		MAPSET(considered, p);
+	}
+    if (considered)
+	update_considered(sack);
+    else
+	invalidate_considered(sack);
+    if (frozen)
+	sack_frozen_unlock(sack);
+    return 0;
+}
+
+/**
+ * Start a group of changes to the excludes, includes and enabled repos.
+ *
+ * Until the matching hy_sack_end_edit() the changes only record what is
+ * excluded, the packages queries consider are computed once at the end.
+ * Groups can nest.
+ */
+void
+hy_sack_begin_edit(HySack sack)
+{
+    sack->edit_depth++;
+}
+
+/**
+ * End the group of changes started by hy_sack_begin_edit().
+ *
+ * @returns	0 on success, HY_E_OP if no group was started.
+ */
+int
+hy_sack_end_edit(HySack sack)
+{
+    if (sack->edit_depth == 0)
+	return HY_E_OP;
+    if (--sack->edit_depth == 0)
+	sack_recompute_considered(sack);
+    return 0;
+}
+
+int
+hy_sack_freeze(HySack sack)
+{
+    Pool *pool = sack_pool(sack);
+    Repo *repo;
+    int i;
+
+    if (sack_frozen(sack))
+	return 0;
+    FOR_REPOS(i, repo)
+	repo_internalize(repo);
+
+    sack_recompute_considered(sack);
+    sack_make_provides_ready(sack);
+    /* pool_whatprovides() fills in the providers of names and relations only
+       when first asked for them */
+    for (Id id = 1; id < pool->ss.nstrings; ++id)
+	pool_whatprovides(pool, id);
+    for (Id rid = 1; rid < pool->nrels; ++rid)
+	pool_whatprovides(pool, MAKERELDEP(rid));
+
+    sack_make_evr_index_ready(sack);
+    sack_make_name_index_ready(sack);
+    sack_make_revdep_index_ready(sack);
+    if (pool->installed)
+	sack_make_installed_index_ready(sack);
+    sack->frozen = 1;
     return 0;
 }
 
@@ -951,7 +1815,7 @@ hy_sack_load_system_repo(HySack sack, HyRepo a_hrepo, int flags)
 	    hrepo->state_main = _HY_LOADED_FETCH;
     }
     if (rc) {
-	repo_free(repo, 1);
+	free_repo(sack, repo);
 	format_err_str("Failed loading RPMDB.");
 	ret = HY_E_IO;
 	goto finish;
@@ -959,7 +1823,7 @@ hy_sack_load_system_repo(HySack sack, HyRepo a_hrepo, int flags)
 
     repo_finalize_init(hrepo, repo);
     pool_set_installed(pool, repo);
-    sack->provides_ready = 0;
+    invalidate_indexes(sack);
 
     const int build_cache = flags & HY_BUILD_CACHE;
     if (hrepo->state_main == _HY_LOADED_FETCH && build_cache) {
@@ -973,7 +1837,7 @@ hy_sack_load_system_repo(HySack sack, HyRepo a_hrepo, int flags)
     hrepo->main_nsolvables = repo->nsolvables;
     hrepo->main_nrepodata = repo->nrepodata;
     hrepo->main_end = repo->end;
-    sack->considered_uptodate = 0;
+    invalidate_considered(sack);
 
  finish:
     if (cache_fp)
@@ -983,11 +1847,12 @@ hy_sack_load_system_repo(HySack sack, HyRepo a_hrepo, int flags)
     return ret;
 }
 
-int
-hy_sack_load_yum_repo(HySack sack, HyRepo repo, int flags)
+static int
+load_yum_repo_parsed(HySack sack, HyRepo repo, int flags,
+		     struct _ParsedRepo *parsed)
 {
     const int build_cache = flags & HY_BUILD_CACHE;
-    int retval = load_yum_repo(sack, repo);
+    int retval = load_yum_repo(sack, repo, parsed);
     if (retval)
 	goto finish;
     repo->load_flags = flags;
@@ -1002,7 +1867,7 @@ hy_sack_load_yum_repo(HySack sack, HyRepo repo, int flags)
     if (flags & HY_LOAD_FILELISTS) {
 	retval = load_ext(sack, repo, _HY_REPODATA_FILENAMES,
 			  HY_EXT_FILENAMES, HY_REPO_FILELISTS_FN,
-			  load_filelists_cb);
+			  load_filelists_cb, parsed);
 	/* allow missing files */
 	if (retval == HY_E_NO_CAPABILITY) {
 	    HY_LOG_INFO("no filelists metadata available for %s", repo->name);
@@ -1020,7 +1885,7 @@ hy_sack_load_yum_repo(HySack sack, HyRepo repo, int flags)
     if (flags & HY_LOAD_PRESTO) {
 	retval = load_ext(sack, repo, _HY_REPODATA_PRESTO,
 			  HY_EXT_PRESTO, HY_REPO_PRESTO_FN,
-			  load_presto_cb);
+			  load_presto_cb, parsed);
 	/* allow missing files */
 	if (retval == HY_E_NO_CAPABILITY) {
 	    HY_LOG_INFO("no presto metadata available for %s", repo->name);
@@ -1036,7 +1901,7 @@ hy_sack_load_yum_repo(HySack sack, HyRepo repo, int flags)
     if (flags & HY_LOAD_UPDATEINFO) {
 	retval = load_ext(sack, repo, _HY_REPODATA_UPDATEINFO,
 			  HY_EXT_UPDATEINFO, HY_REPO_UPDATEINFO_FN,
-			  load_updateinfo_cb);
+			  load_updateinfo_cb, parsed);
 	/* allow missing files */
 	if (retval == HY_E_NO_CAPABILITY) {
 	    HY_LOG_INFO("no updateinfo available for %s", repo->name);
@@ -1047,7 +1912,7 @@ hy_sack_load_yum_repo(HySack sack, HyRepo repo, int flags)
 	if (repo->state_updateinfo == _HY_LOADED_FETCH && build_cache)
 	    retval = write_ext(sack, repo, _HY_REPODATA_UPDATEINFO, HY_EXT_UPDATEINFO);
     }
-    sack->considered_uptodate = 0;
+    invalidate_considered(sack);
  finish:
     if (retval) {
 	hy_errno = retval;
@@ -1056,6 +1921,72 @@ hy_sack_load_yum_repo(HySack sack, HyRepo repo, int flags)
     return 0;
 }
 
+int
+hy_sack_load_yum_repo(HySack sack, HyRepo repo, int flags)
+{
+    return load_yum_repo_parsed(sack, repo, flags, NULL);
+}
+
+/**
+ * Load several yum repos, with the same effect as calling
+ * hy_sack_load_yum_repo() on each of them in turn.
+ *
+ * Metadata that can not be taken from the cache is parsed in up to
+ * 'nthreads' threads (as many as there are online CPUs if 'nthreads' is 0),
+ * each repo into a private Pool. The results are then merged into the sack
+ * in the order of 'repos' on the calling thread. Updateinfo is always parsed
+ * during the merge.
+ *
+ * Stops at the first repo that fails to load, returning HY_E_FAILED and
+ * setting hy_errno just like hy_sack_load_yum_repo() does.
+ */
+int
+hy_sack_load_yum_repos(HySack sack, HyRepo *repos, int nrepos, int flags,
+		       int nthreads)
+{
+    struct _ParsedRepo *parsed = solv_calloc(nrepos, sizeof(*parsed));
+    struct _ParseQueue queue;
+    int ret = 0;
+
+    if (nthreads <= 0)
+	nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (nthreads > nrepos)
+	nthreads = nrepos;
+
+    for (int i = 0; i < nrepos; ++i) {
+	parsed[i].sack = sack;
+	parsed[i].hrepo = repos[i];
+	parsed[i].flags = flags;
+    }
+    queue.parsed = parsed;
+    queue.nparsed = nrepos;
+    queue.next = 0;
+    pthread_mutex_init(&queue.lock, NULL);
+
+    /* with a single thread there is nothing to gain from parsing ahead */
+    if (nthreads > 1) {
+	pthread_t threads[nthreads];
+	int started = 0;
+
+	while (started < nthreads &&
+	       !pthread_create(threads + started, NULL, parse_worker, &queue))
+	    started++;
+	if (started < nthreads)
+	    HY_LOG_ERROR("only started %d of %d threads", started, nthreads);
+	for (int i = 0; i < started; ++i)
+	    pthread_join(threads[i], NULL);
+    }
+    pthread_mutex_destroy(&queue.lock);
+
+    for (int i = 0; i < nrepos && !ret; ++i)
+	ret = load_yum_repo_parsed(sack, repos[i], flags, parsed + i);
+
+    for (int i = 0; i < nrepos; ++i)
+	parsed_repo_free(parsed + i);
+    solv_free(parsed);
+    return ret;
+}
+
 // internal to hawkey
 
 // return true if q1 is a superset of q2
@@ -1076,7 +2007,6 @@ is_superset(Queue *q1, Queue *q2, Map *m)
     return cnt == q2->count;
 }
 
-
 static void
 rewrite_repos(HySack sack, Queue *addedfileprovides,
 	      Queue *addedfileprovides_inst)
@@ -1132,12 +2062,18 @@ rewrite_repos(HySack sack, Queue *addedfileprovides,
     map_free(&providedids);
 }
 
+/* only the added file provides outlive the process: rewrite_repos() stores
+   them in each repo's cache and a later process skips the filelist search.
+   the whatprovides arrays are computed every time, libsolv keeps part of
+   their state private (addedfileprovides, the aux helper) so they can not be
+   restored from a file through its API */
 void
 sack_make_provides_ready(HySack sack)
 {
     if (!sack->provides_ready) {
 	Queue addedfileprovides;
 	Queue addedfileprovides_inst;
+	sack->frozen = 0;
 	queue_init(&addedfileprovides);
 	queue_init(&addedfileprovides_inst);
 	pool_addfileprovides_queue(sack->pool, &addedfileprovides,
@@ -1151,6 +2087,416 @@ sack_make_provides_ready(HySack sack)
     }
 }
 
+static int
+evr_index_intern(Pool *pool, const char *str, int *dense, Id **ids, int *nids)
+{
+    Id id = str ? pool_str2id(pool, str, 1) : ID_EMPTY;
+
+    if (dense[id] < 0) {
+	*ids = solv_extend(*ids, *nids, 1, sizeof(Id), 255);
+	(*ids)[*nids] = id;
+	dense[id] = (*nids)++;
+    }
+    return dense[id];
+}
+
+/**
+ * Make sure sack->evr_index holds the split EVR of every solvable.
+ *
+ * The split versions and releases are interned and numbered densely so
+ * filters only compare each distinct value once.
+ */
+void
+sack_make_evr_index_ready(HySack sack)
+{
+    Pool *pool = sack_pool(sack);
+    struct _EvrIndex *idx = sack->evr_index;
+
+    if (idx && idx->nsolvables == pool->nsolvables)
+	return;
+    evr_index_free(idx);
+    idx = solv_calloc(1, sizeof(*idx));
+    idx->nsolvables = pool->nsolvables;
+    idx->epochs = solv_calloc(pool->nsolvables, sizeof(unsigned long));
+    idx->versions = solv_malloc2(pool->nsolvables, sizeof(int));
+    idx->releases = solv_malloc2(pool->nsolvables, sizeof(int));
+
+    /* interning can grow the string space, leave some room for that */
+    int ndense = pool->ss.nstrings + 2 * pool->nsolvables;
+    int *vdense = solv_malloc2(ndense, sizeof(int));
+    int *rdense = solv_malloc2(ndense, sizeof(int));
+    memset(vdense, -1, ndense * sizeof(int));
+    memset(rdense, -1, ndense * sizeof(int));
+
+    for (Id id = 0; id < pool->nsolvables; ++id) {
+	Solvable *s = pool_id2solvable(pool, id);
+	char *e, *v, *r;
+
+	idx->versions[id] = idx->releases[id] = -1;
+	if (id == 0 || s->evr == ID_EMPTY)
+	    continue;
+	const char *evr = pool_id2str(pool, s->evr);
+	idx->epochs[id] = pool_get_epoch(pool, evr);
+	pool_split_evr(pool, evr, &e, &v, &r);
+	idx->versions[id] = evr_index_intern(pool, v, vdense,
+					     &idx->vids, &idx->nvids);
+	idx->releases[id] = evr_index_intern(pool, r, rdense,
+					     &idx->rids, &idx->nrids);
+    }
+    solv_free(vdense);
+    solv_free(rdense);
+    sack->evr_index = idx;
+}
+
+static int
+name_index_sortcmp(const void *ap, const void *bp, void *dp)
+{
+    Pool *pool = dp;
+    Id a = *(Id *)ap;
+    Id b = *(Id *)bp;
+    Id name_a = pool_id2solvable(pool, a)->name;
+    Id name_b = pool_id2solvable(pool, b)->name;
+
+    if (name_a != name_b)
+	return strcmp(pool_id2str(pool, name_a), pool_id2str(pool, name_b));
+    return a - b;
+}
+
+/**
+ * Make sure sack->name_index groups all the package solvables by name.
+ *
+ * Solvables of disabled repos are indexed too, it is up to the user of the
+ * index to skip them.
+ */
+void
+sack_make_name_index_ready(HySack sack)
+{
+    Pool *pool = sack_pool(sack);
+    struct _NameIndex *idx = sack->name_index;
+    int count = 0;
+    Id p;
+
+    if (idx && idx->nsolvables == pool->nsolvables)
+	return;
+    name_index_free(idx);
+    idx = solv_calloc(1, sizeof(*idx));
+    idx->nsolvables = pool->nsolvables;
+    idx->solvables = solv_malloc2(pool->nsolvables, sizeof(Id));
+    FOR_PKG_SOLVABLES(p)
+	idx->solvables[count++] = p;
+    solv_sort(idx->solvables, count, sizeof(Id), name_index_sortcmp, pool);
+
+    Id last = 0;
+    for (int i = 0; i < count; ++i) {
+	Id name = pool_id2solvable(pool, idx->solvables[i])->name;
+	if (i && name == last)
+	    continue;
+	idx->names = solv_extend(idx->names, idx->nnames, 1, sizeof(Id), 255);
+	idx->starts = solv_extend(idx->starts, idx->nnames, 1, sizeof(int), 255);
+	idx->names[idx->nnames] = name;
+	idx->starts[idx->nnames++] = i;
+	last = name;
+    }
+    idx->starts = solv_extend(idx->starts, idx->nnames, 1, sizeof(int), 255);
+    idx->starts[idx->nnames] = count;
+    sack->name_index = idx;
+}
+
+static void
+revdep_index_add(Pool *pool, struct _RevdepIndex *idx, Id p, int key, Id dep)
+{
+    while (ISRELDEP(dep)) {
+	Reldep *rd = GETRELDEP(pool, dep);
+	/* rich dependencies can match through either side */
+	if (rd->flags >= 8 && rd->flags != REL_ARCH)
+	    revdep_index_add(pool, idx, p, key, rd->evr);
+	dep = rd->name;
+    }
+
+    if (dep >= idx->nheads) {
+	int nheads = pool->ss.nstrings;
+	idx->heads = solv_realloc2(idx->heads, nheads, sizeof(int));
+	for (int i = idx->nheads; i < nheads; ++i)
+	    idx->heads[i] = -1;
+	idx->nheads = nheads;
+    }
+
+    int head = idx->heads[dep];
+    if (head >= 0 && idx->entries[head].solvable == p) {
+	/* p mentioned the name before */
+	idx->entries[head].keys |= key;
+	return;
+    }
+    idx->entries = solv_extend(idx->entries, idx->nentries, 1,
+			       sizeof(struct _RevdepEntry), 1023);
+    struct _RevdepEntry *entry = idx->entries + idx->nentries;
+    entry->solvable = p;
+    entry->keys = key;
+    entry->next = head;
+    idx->heads[dep] = idx->nentries++;
+}
+
+static void
+revdep_index_add_deps(Pool *pool, struct _RevdepIndex *idx, Solvable *s,
+		      int key, Offset deps)
+{
+    if (!deps)
+	return;
+    for (Id *dp = s->repo->idarraydata + deps; *dp; ++dp)
+	revdep_index_add(pool, idx, pool_solvable2id(pool, s), key, *dp);
+}
+
+/**
+ * Make sure sack->revdep_index maps every dependency name to the solvables
+ * mentioning it in their requires, conflicts or obsoletes.
+ *
+ * The index is a superset: the dependencies of the solvables it yields still
+ * need to be matched. Solvables are only ever appended to the pool so only
+ * the ones added since the last call are indexed.
+ */
+void
+sack_make_revdep_index_ready(HySack sack)
+{
+    Pool *pool = sack_pool(sack);
+    struct _RevdepIndex *idx = sack->revdep_index;
+
+    if (idx && idx->nsolvables == pool->nsolvables)
+	return;
+    if (idx && idx->nsolvables > pool->nsolvables)
+	idx = revdep_index_free(idx); // a repo went away
+    if (idx == NULL) {
+	idx = solv_calloc(1, sizeof(*idx));
+	idx->nsolvables = 1;
+	sack->revdep_index = idx;
+    }
+
+    for (Id p = idx->nsolvables; p < pool->nsolvables; ++p) {
+	Solvable *s = pool_id2solvable(pool, p);
+	if (!s->repo)
+	    continue;
+	revdep_index_add_deps(pool, idx, s, REVDEP_REQUIRES, s->requires);
+	revdep_index_add_deps(pool, idx, s, REVDEP_CONFLICTS, s->conflicts);
+	revdep_index_add_deps(pool, idx, s, REVDEP_OBSOLETES, s->obsoletes);
+    }
+    idx->nsolvables = pool->nsolvables;
+}
+
+/**
+ * Make sure sack->installed_index holds, for every name and arch installed,
+ * the installed packages of the highest and the lowest EVR.
+ *
+ * Rebuilt whenever the pool grows or a different repo is made the installed
+ * one.
+ */
+void
+sack_make_installed_index_ready(HySack sack)
+{
+    Pool *pool = sack_pool(sack);
+    struct _InstalledIndex *idx = sack->installed_index;
+    Solvable *s;
+    Id p;
+
+    if (idx && idx->installed == pool->installed &&
+	idx->nsolvables == pool->nsolvables)
+	return;
+    installed_index_free(idx);
+    idx = solv_calloc(1, sizeof(*idx));
+    idx->installed = pool->installed;
+    idx->nsolvables = pool->nsolvables;
+    idx->nheads = pool->ss.nstrings;
+    idx->heads = solv_malloc2(idx->nheads, sizeof(int));
+    memset(idx->heads, -1, idx->nheads * sizeof(int));
+    sack->installed_index = idx;
+    if (!pool->installed)
+	return;
+
+    FOR_REPO_SOLVABLES(pool->installed, p, s) {
+	int e = idx->heads[s->name];
+	while (e >= 0 && idx->entries[e].arch != s->arch)
+	    e = idx->entries[e].next;
+	if (e < 0) {
+	    idx->entries = solv_extend(idx->entries, idx->nentries, 1,
+				       sizeof(struct _InstalledEntry), 255);
+	    struct _InstalledEntry *entry = idx->entries + idx->nentries;
+	    entry->arch = s->arch;
+	    entry->highest = entry->lowest = p;
+	    entry->next = idx->heads[s->name];
+	    idx->heads[s->name] = idx->nentries++;
+	    continue;
+	}
+
+	struct _InstalledEntry *entry = idx->entries + e;
+	Id highest_evr = pool_id2solvable(pool, entry->highest)->evr;
+	Id lowest_evr = pool_id2solvable(pool, entry->lowest)->evr;
+	if (s->evr != highest_evr &&
+	    pool_evrcmp(pool, s->evr, highest_evr, EVRCMP_COMPARE) > 0)
+	    entry->highest = p;
+	else if (s->evr != lowest_evr &&
+		 pool_evrcmp(pool, s->evr, lowest_evr, EVRCMP_COMPARE) < 0)
+	    entry->lowest = p;
+    }
+}
+
+void
+sack_frozen_lock(HySack sack, int exclusive)
+{
+    if (exclusive)
+	pthread_rwlock_wrlock(&sack->locks->frozen);
+    else
+	pthread_rwlock_rdlock(&sack->locks->frozen);
+}
+
+void
+sack_frozen_unlock(HySack sack)
+{
+    pthread_rwlock_unlock(&sack->locks->frozen);
+}
+
+void
+sack_tmpspace_lock(HySack sack)
+{
+    pthread_mutex_lock(&sack->locks->tmpspace);
+}
+
+void
+sack_tmpspace_unlock(HySack sack)
+{
+    pthread_mutex_unlock(&sack->locks->tmpspace);
+}
+
+/* if a query with the canonical 'key' is cached, initialize 'result' to a
+   copy of its result and return 1. */
+int
+sack_query_cache_lookup(HySack sack, const unsigned char *key, int keylen,
+			Map *result)
+{
+    struct _QueryCache *cache;
+    struct _QueryCacheEntry *e;
+    int found = 0;
+
+    pthread_mutex_lock(&sack->locks->query_cache);
+    cache = sack->query_cache;
+    if (cache) {
+	query_cache_validate(sack, cache);
+	e = query_cache_find(cache, key, keylen, query_cache_hash(key, keylen));
+	if (e) {
+	    map_init_clone(result, &e->result);
+	    e->used = ++cache->tick;
+	    cache->hits++;
+	    found = 1;
+	} else
+	    cache->misses++;
+    }
+    pthread_mutex_unlock(&sack->locks->query_cache);
+    return found;
+}
+
+/* store a copy of 'result' under 'key', evicting the least recently used
+   entry if the cache is full */
+void
+sack_query_cache_store(HySack sack, const unsigned char *key, int keylen,
+		       const Map *result)
+{
+    struct _QueryCache *cache;
+    struct _QueryCacheEntry *e;
+    unsigned hash = query_cache_hash(key, keylen);
+
+    pthread_mutex_lock(&sack->locks->query_cache);
+    cache = sack->query_cache;
+    if (cache == NULL)
+	goto finish;
+    query_cache_validate(sack, cache);
+    // another thread could have computed the same meanwhile
+    if (query_cache_find(cache, key, keylen, hash))
+	goto finish;
+    e = cache->entries;
+    for (int i = 1; i < cache->nentries && e->used; ++i)
+	if (cache->entries[i].used < e->used)
+	    e = cache->entries + i;
+    if (e->used) {
+	solv_free(e->key);
+	map_free(&e->result);
+    }
+    e->key = solv_memdup(key, keylen);
+    e->keylen = keylen;
+    e->hash = hash;
+    map_init_clone(&e->result, result);
+    e->used = ++cache->tick;
+ finish:
+    pthread_mutex_unlock(&sack->locks->query_cache);
+}
+
+/* an idle solver for the current packages, NULL if there is none. its flags
+   are as its last goal left them. */
+Solver *
+sack_take_solver(HySack sack)
+{
+    struct _SolverCache *cache;
+    Solver *solv = NULL;
+
+    pthread_mutex_lock(&sack->locks->solver_cache);
+    cache = sack->solver_cache;
+    if (cache) {
+	solver_cache_validate(sack, cache);
+	if (cache->nsolvers)
+	    solv = cache->solvers[--cache->nsolvers];
+    }
+    pthread_mutex_unlock(&sack->locks->solver_cache);
+    return solv;
+}
+
+/* hand a goal's solver back for the next goals, or free it if the cache is
+   off or full */
+void
+sack_give_solver(HySack sack, Solver *solv)
+{
+    struct _SolverCache *cache;
+
+    pthread_mutex_lock(&sack->locks->solver_cache);
+    cache = sack->solver_cache;
+    if (cache) {
+	solver_cache_validate(sack, cache);
+	if (cache->nsolvers < cache->size) {
+	    cache->solvers[cache->nsolvers++] = solv;
+	    solv = NULL;
+	}
+    }
+    pthread_mutex_unlock(&sack->locks->solver_cache);
+    if (solv)
+	solver_free(solv);
+}
+
+/* the NEVRA of solvable 'p', built on the first call. the string stays valid
+   until a repo is freed or the sack is. */
+const char *
+sack_get_nevra(HySack sack, Id p)
+{
+    struct _NevraCache *cache;
+    const char *nevra;
+
+    pthread_mutex_lock(&sack->locks->nevras);
+    cache = sack->nevra_cache;
+    if (cache == NULL)
+	cache = sack->nevra_cache = solv_calloc(1, sizeof(*cache));
+    if (p >= cache->nnevras) {
+	int nnevras = sack_pool(sack)->nsolvables;
+	assert(p < nnevras);
+	cache->nevras = solv_extend_realloc(cache->nevras, nnevras,
+					    sizeof(const char *), 255);
+	memset(cache->nevras + cache->nnevras, 0,
+	       (nnevras - cache->nnevras) * sizeof(const char *));
+	cache->nnevras = nnevras;
+    }
+    nevra = cache->nevras[p];
+    if (nevra == NULL) {
+	Pool *pool = sack_pool(sack);
+	nevra = cache->nevras[p] =
+	    nevra_cache_add(cache, pool, pool_id2solvable(pool, p));
+    }
+    pthread_mutex_unlock(&sack->locks->nevras);
+    return nevra;
+}
+
 Id
 sack_running_kernel(HySack sack)
 {
@@ -1166,13 +2512,12 @@ sack_log(HySack sack, int level, const char *format, ...)
     Pool *pool = sack_pool(sack);
     char buf[1024];
     va_list args;
-    const char *format_nl = pool_tmpjoin(pool, format, "\n", NULL);
 
     /* add a newline and forward everything to the pool logging */
     va_start(args, format);
-    vsnprintf(buf, sizeof(buf), format_nl, args);
+    vsnprintf(buf, sizeof(buf), format, args);
     va_end(args);
-    POOL_DEBUG(level, "%s", buf);
+    POOL_DEBUG(level, "%s\n", buf);
 }
 
 int
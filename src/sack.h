@@ -49,6 +49,11 @@ char *hy_sack_give_cache_fn(HySack sack, const char *reponame, const char *ext);
 const char **hy_sack_list_arches(HySack sack);
 void hy_sack_set_installonly(HySack sack, const char **installonly);
 void hy_sack_set_installonly_limit(HySack sack, int limit);
+void hy_sack_set_query_threads(HySack sack, int nthreads);
+void hy_sack_set_query_cache_size(HySack sack, int nentries);
+unsigned long hy_sack_get_query_cache_hits(HySack sack);
+unsigned long hy_sack_get_query_cache_misses(HySack sack);
+void hy_sack_set_solver_cache_size(HySack sack, int nsolvers);
 void hy_sack_create_cmdline_repo(HySack sack);
 HyPackage hy_sack_add_cmdline_package(HySack sack, const char *fn);
 int hy_sack_count(HySack sack);
@@ -57,6 +62,25 @@ void hy_sack_add_includes(HySack sack, HyPackageSet pset);
 void hy_sack_set_excludes(HySack sack, HyPackageSet pset);
 void hy_sack_set_includes(HySack sack, HyPackageSet pset);
 int hy_sack_repo_enabled(HySack sack, const char *reponame, int enabled);
+void hy_sack_begin_edit(HySack sack);
+int hy_sack_end_edit(HySack sack);
+
+/**
+ * Finish all the lazily computed state of the sack.
+ *
+ * Afterwards hy_query_run() and hy_query_run_set() can be called from several
+ * threads at once, each on its own query. Adding excludes or includes once
+ * some are set up keeps the sack frozen and is safe while queries run. Other
+ * changes (loading repos, setting the excludes or includes) thaw it, freeze
+ * again before querying concurrently.
+ *
+ * hy_sack_repo_enabled() also updates the considered packages in place, but
+ * the providers then have to be computed again: the sack is thawed once it
+ * returns and has to be frozen again as well.
+ *
+ * @returns           0.
+ */
+int hy_sack_freeze(HySack sack);
 
 /**
  * Load RPMDB, the system package database.
@@ -66,6 +90,8 @@ int hy_sack_repo_enabled(HySack sack, const char *reponame, int enabled);
  */
 int hy_sack_load_system_repo(HySack sack, HyRepo a_hrepo, int flags);
 int hy_sack_load_yum_repo(HySack sack, HyRepo hrepo, int flags);
+int hy_sack_load_yum_repos(HySack sack, HyRepo *hrepos, int nrepos, int flags,
+			   int nthreads);
 
 #ifdef __cplusplus
 }
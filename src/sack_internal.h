@@ -25,12 +25,82 @@
 
 // libsolv
 #include <solv/pool.h>
+#include <solv/solver.h>
 
 // hawkey
 #include "sack.h"
 
 typedef Id(*running_kernel_fn_t)(HySack);
 
+/* solvables a query thread scans at a time, see scan() in query.c. a
+   multiple of 8 so the threads never share a byte of the result map */
+#define SCAN_CHUNK 4096
+
+/* split EVRs of all the solvables, see sack_make_evr_index_ready() */
+struct _EvrIndex {
+    int nsolvables;
+    unsigned long *epochs;
+    /* per solvable indices into the distinct vids/rids, -1 if without EVR */
+    int *versions;
+    int *releases;
+    Id *vids;
+    int nvids;
+    Id *rids;
+    int nrids;
+};
+
+/* package solvables grouped by name, see sack_make_name_index_ready() */
+struct _NameIndex {
+    int nsolvables;
+    /* distinct names sorted by strcmp(), solvables of names[i] are
+       solvables[starts[i]] to solvables[starts[i + 1] - 1] */
+    Id *names;
+    int nnames;
+    int *starts;
+    Id *solvables;
+};
+
+/* solvables by the names their requires, conflicts and obsoletes mention,
+   see sack_make_revdep_index_ready() */
+#define REVDEP_REQUIRES		(1 << 0)
+#define REVDEP_CONFLICTS	(1 << 1)
+#define REVDEP_OBSOLETES	(1 << 2)
+
+struct _RevdepEntry {
+    Id solvable;
+    int keys;			/* REVDEP_* the name is mentioned in */
+    int next;			/* next entry of the same name, -1 ends */
+};
+
+struct _RevdepIndex {
+    int nsolvables;		/* solvables below this are indexed */
+    /* per name Id, the last added entry mentioning it or -1. the entries of
+       a name go down the solvable Ids */
+    int *heads;
+    int nheads;
+    struct _RevdepEntry *entries;
+    int nentries;
+};
+
+/* installed packages of one name and arch, see
+   sack_make_installed_index_ready() */
+struct _InstalledEntry {
+    Id arch;
+    Id highest;			/* of the highest EVR, the lowest Id on ties */
+    Id lowest;			/* of the lowest EVR, the lowest Id on ties */
+    int next;			/* next arch of the same name, -1 ends */
+};
+
+struct _InstalledIndex {
+    Repo *installed;
+    int nsolvables;
+    /* per name Id, the first entry of the name or -1 */
+    int *heads;
+    int nheads;
+    struct _InstalledEntry *entries;
+    int nentries;
+};
+
 struct _HySack {
     Pool *pool;
     int provides_ready;
@@ -40,20 +110,58 @@ struct _HySack {
     char *log_file;
     Queue installonly;
     int installonly_limit;
+    int query_threads;
+    int scan_chunk;		/* SCAN_CHUNK, smaller in the tests */
     FILE *log_out;
     Map *pkg_excludes;
     Map *pkg_includes;
     Map *repo_excludes;
     int considered_uptodate;
+    int edit_depth;		/* see hy_sack_begin_edit() */
     int cmdline_repo_created;
+    struct _EvrIndex *evr_index;
+    struct _NameIndex *name_index;
+    struct _RevdepIndex *revdep_index;
+    struct _InstalledIndex *installed_index;
+    int frozen;			/* see hy_sack_freeze() */
+    struct _SackLocks *locks;
+    /* bumped whenever the packages queries consider change */
+    unsigned generation;
+    struct _QueryCache *query_cache;
+    struct _NevraCache *nevra_cache;
+    struct _SolverCache *solver_cache;
+    struct _Workers *workers;
+    /* parallel hy_goal_run_batch() calls and the debug mask before them */
+    int quiet_batches;
+    int batch_debugmask;
 };
 
 void sack_make_provides_ready(HySack sack);
+void sack_make_evr_index_ready(HySack sack);
+void sack_make_name_index_ready(HySack sack);
+void sack_make_revdep_index_ready(HySack sack);
+void sack_make_installed_index_ready(HySack sack);
 Id sack_running_kernel(HySack sack);
 void sack_log(HySack sack, int level, const char *format, ...);
 int sack_knows(HySack sack, const char *name, const char *version, int flags);
 void sack_recompute_considered(HySack sack);
+void sack_frozen_lock(HySack sack, int exclusive);
+void sack_frozen_unlock(HySack sack);
+void sack_tmpspace_lock(HySack sack);
+void sack_tmpspace_unlock(HySack sack);
+int sack_query_cache_lookup(HySack sack, const unsigned char *key, int keylen,
+			    Map *result);
+void sack_query_cache_store(HySack sack, const unsigned char *key, int keylen,
+			    const Map *result);
+const char *sack_get_nevra(HySack sack, Id p);
+Solver *sack_take_solver(HySack sack);
+void sack_give_solver(HySack sack, Solver *solv);
+void sack_run_workers(HySack sack, void (*fn)(void *), void *arg);
 static inline Pool *sack_pool(HySack sack) { return sack->pool; }
+static inline int sack_frozen(HySack sack)
+{
+    return sack->frozen && sack->provides_ready && sack->considered_uptodate;
+}
 static inline Id sack_last_solvable(HySack sack)
 {
     return sack_pool(sack)->nsolvables - 1;
@@ -52,6 +52,7 @@ typedef char * HySubject;
 typedef const unsigned char HyChecksum;
 
 typedef int (*hy_solution_callback)(HyGoal goal, void *callback_data);
+typedef int (*hy_packageset_callback)(HyPackage pkg, void *callback_data);
 
 #define HY_SYSTEM_REPO_NAME "@System"
 #define HY_CMDLINE_REPO_NAME "@commandline"
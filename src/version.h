@@ -0,0 +1,22 @@
+#ifndef HY_VERSION_H
+#define HY_VERSION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HY_VERSION_MAJOR 0
+#define HY_VERSION_MINOR 5
+#define HY_VERSION_PATCH 3
+
+#define HY_VERSION_CHECK(major,minor,patch)    \
+    (HY_VERSION_MAJOR > (major) || \
+     (HY_VERSION_MAJOR == (major) && HY_VERSION_MINOR > (minor)) || \
+     (HY_VERSION_MAJOR == (major) && HY_VERSION_MINOR == (minor) && \
+      HY_VERSION_PATCH >= (patch)))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HY_VERSION_H */
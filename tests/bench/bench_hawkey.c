@@ -0,0 +1,770 @@
+/*
+ * Copyright (C) 2015 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Benchmark suite over synthetic repos (see benchgen.h): yum repo loading,
+ * the common query shapes, an upgrade of everything and many small goals.
+ * The results are written as JSON, a summary goes to stderr.
+ *
+ * usage: bench_hawkey [-o results.json] [-r rounds] [-t query threads]
+ *		       [nsolvables...]
+ */
+
+#define _GNU_SOURCE
+#include <ftw.h>
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// libsolv
+#include <solv/evr.h>
+#include <solv/solvversion.h>
+#include <solv/util.h>
+
+// hawkey
+#include "src/goal.h"
+#include "src/package.h"
+#include "src/packagelist.h"
+#include "src/packageset.h"
+#include "src/packagetable.h"
+#include "src/query.h"
+#include "src/repo.h"
+#include "src/sack_internal.h"
+#include "src/selector.h"
+#include "src/version.h"
+#include "tests/testshared.h"
+#include "benchgen.h"
+
+struct _BenchCtx {
+    FILE *out;
+    int nresults;
+    int rounds;
+    int nsolvables;
+    int query_threads;
+    char *dir;
+    HySack sack;	// @System and the available packages, for queries
+};
+
+typedef int (*bench_query_fn)(HySack sack);
+
+static double
+now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void
+report(struct _BenchCtx *ctx, const char *name, int rounds, const double *ms)
+{
+    double total = 0, min = ms[0];
+
+    for (int i = 0; i < rounds; ++i) {
+	total += ms[i];
+	if (ms[i] < min)
+	    min = ms[i];
+    }
+    fprintf(ctx->out, "%s\n    {\"benchmark\": \"%s\", \"solvables\": %d, "
+	    "\"rounds\": %d, \"mean_ms\": %.3f, \"min_ms\": %.3f}",
+	    ctx->nresults++ ? "," : "", name, ctx->nsolvables, rounds,
+	    total / rounds, min);
+    fprintf(stderr, "%-28s %8d %12.3f ms\n", name, ctx->nsolvables,
+	    total / rounds);
+}
+
+static int
+rm_cb(const char *fpath, const struct stat *sb, int typeflag,
+      struct FTW *ftwbuf)
+{
+    return remove(fpath);
+}
+
+static HySack
+create_sack(const char *cachedir)
+{
+    return hy_sack_create(cachedir, TEST_FIXED_ARCH, NULL, NULL,
+			  HY_MAKE_CACHE_DIR);
+}
+
+/* the NEVRA of every package, as 'dnf list' prints them */
+static int
+list_nevras(HySack sack)
+{
+    HyQuery q = hy_query_create(sack);
+    HyPackageList plist = hy_query_run(q);
+    size_t total = 0;
+
+    for (int i = 0; i < hy_packagelist_count(plist); ++i) {
+	char *nevra = hy_package_get_nevra(hy_packagelist_get(plist, i));
+	total += strlen(nevra);
+	solv_free(nevra);
+    }
+    hy_packagelist_free(plist);
+    hy_query_free(q);
+    return total == 0;
+}
+
+/* load the yum repo with 'flags', and list it after if 'list' is set */
+static int
+load_yum(struct _BenchCtx *ctx, const char *cachedir, int flags, int list,
+	 double *ms)
+{
+    HySack sack = create_sack(cachedir);
+    Pool *pool = sack_pool(sack);
+    HyRepo repo = hy_repo_create("bench");
+    int ret;
+
+    hy_repo_set_string(repo, HY_REPO_MD_FN,
+		       pool_tmpjoin(pool, ctx->dir, "/yum/repodata/repomd.xml",
+				    NULL));
+    hy_repo_set_string(repo, HY_REPO_PRIMARY_FN,
+		       pool_tmpjoin(pool, ctx->dir, "/yum/repodata/primary.xml",
+				    NULL));
+    hy_repo_set_string(repo, HY_REPO_FILELISTS_FN,
+		       pool_tmpjoin(pool, ctx->dir,
+				    "/yum/repodata/filelists.xml", NULL));
+    double start = now();
+    ret = hy_sack_load_yum_repo(sack, repo, HY_BUILD_CACHE | flags);
+    if (!ret && list)
+	ret = list_nevras(sack);
+    *ms = (now() - start) * 1000;
+    hy_repo_free(repo);
+    hy_sack_free(sack);
+    return ret;
+}
+
+static long
+status_kb(const char *field)
+{
+    FILE *fp = fopen("/proc/self/status", "r");
+    size_t len = strlen(field);
+    char line[256];
+    long kb = -1;
+
+    if (fp == NULL)
+	return -1;
+    while (fgets(line, sizeof(line), fp))
+	if (!strncmp(line, field, len)) {
+	    kb = atol(line + len);
+	    break;
+	}
+    fclose(fp);
+    return kb;
+}
+
+/* load_yum() and list in a child process, to get the peak RSS of just the
+   one load in 'kb' */
+static int
+load_yum_child(struct _BenchCtx *ctx, const char *cachedir, int flags,
+	       double *ms, long *kb)
+{
+    struct { double ms; long kb; int ret; } res = {0, -1, 1};
+    int fds[2], status;
+
+    if (pipe(fds))
+	return 1;
+    fflush(NULL);
+    pid_t pid = fork();
+    if (pid == 0) {
+	FILE *fp = fopen("/proc/self/clear_refs", "w");
+	// reset the peak RSS inherited from the parent, and give back the
+	// free memory of its heap so the load can't grow in there unseen
+	malloc_trim(0);
+	if (fp) {
+	    fputs("5", fp);
+	    fclose(fp);
+	}
+	long base = status_kb("VmRSS:");
+	res.ret = load_yum(ctx, cachedir, flags, 1, &res.ms);
+	res.kb = status_kb("VmHWM:") - base;
+	_exit(write(fds[1], &res, sizeof(res)) != sizeof(res));
+    }
+    close(fds[1]);
+    if (pid < 0 || read(fds[0], &res, sizeof(res)) != sizeof(res))
+	res.ret = 1;
+    close(fds[0]);
+    if (pid > 0)
+	waitpid(pid, &status, 0);
+    *ms = res.ms;
+    *kb = res.kb;
+    return res.ret;
+}
+
+static void
+report_rss(struct _BenchCtx *ctx, const char *name, long kb)
+{
+    fprintf(ctx->out, "%s\n    {\"benchmark\": \"%s\", \"solvables\": %d, "
+	    "\"peak_rss_kb\": %ld}",
+	    ctx->nresults++ ? "," : "", name, ctx->nsolvables, kb);
+    fprintf(stderr, "%-28s %8d %12ld kB\n", name, ctx->nsolvables, kb);
+}
+
+/* a short command like 'dnf list installed' without and with the cached
+   filelists, which the listing does not need. hy_sack_load_system_repo()
+   always reads the whole @System cache, these only cover the yum repos. */
+static int
+bench_load_filelists(struct _BenchCtx *ctx, const char *cachedir, int rounds)
+{
+    const struct {
+	const char *name;
+	int flags;
+    } modes[] = {
+	{"sack_load_list", 0},
+	{"sack_load_list_filelists", HY_LOAD_FILELISTS},
+    };
+    char name[64];
+    double ms[rounds];
+    long kb, peak;
+
+    // parse the filelists into the cache once
+    if (load_yum(ctx, cachedir, HY_LOAD_FILELISTS, 0, ms))
+	return 1;
+    for (unsigned m = 0; m < sizeof(modes) / sizeof(*modes); ++m) {
+	peak = 0;
+	for (int i = 0; i < rounds; ++i) {
+	    if (load_yum_child(ctx, cachedir, modes[m].flags, ms + i, &kb))
+		return 1;
+	    if (kb > peak)
+		peak = kb;
+	}
+	report(ctx, modes[m].name, rounds, ms);
+	snprintf(name, sizeof(name), "%s_rss", modes[m].name);
+	report_rss(ctx, name, peak);
+    }
+    return 0;
+}
+
+static int
+bench_load(struct _BenchCtx *ctx)
+{
+    const int rounds = ctx->rounds / 10 > 0 ? ctx->rounds / 10 : 1;
+    char yumdir[4096], cachedir[4096];
+    double ms[rounds];
+
+    snprintf(yumdir, sizeof(yumdir), "%s/yum", ctx->dir);
+    if (mkdir(yumdir, 0777) || benchgen_write_yum(yumdir, ctx->nsolvables)) {
+	fprintf(stderr, "can not write the yum repo to %s\n", yumdir);
+	return 1;
+    }
+    // cold: parse the XML and write the cache, a fresh cache every round
+    for (int i = 0; i < rounds; ++i) {
+	snprintf(cachedir, sizeof(cachedir), "%s/cache%d", ctx->dir, i);
+	if (load_yum(ctx, cachedir, 0, 0, ms + i))
+	    goto fail;
+    }
+    report(ctx, "sack_load_yum_cold", rounds, ms);
+    // cached: the .solv the last round wrote
+    for (int i = 0; i < rounds; ++i)
+	if (load_yum(ctx, cachedir, 0, 0, ms + i))
+	    goto fail;
+    report(ctx, "sack_load_yum_cached", rounds, ms);
+    if (bench_load_filelists(ctx, cachedir, rounds))
+	goto fail;
+    return 0;
+
+ fail:
+    fprintf(stderr, "can not load the yum repo in %s\n", yumdir);
+    return 1;
+}
+
+static int
+run_query(HyQuery q)
+{
+    HyPackageSet pset = hy_query_run_set(q);
+    int count = hy_packageset_count(pset);
+    hy_packageset_free(pset);
+    hy_query_free(q);
+    return count;
+}
+
+static int
+q_name_eq(HySack sack)
+{
+    HyQuery q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "pkg000042");
+    return run_query(q);
+}
+
+static int
+q_name_glob(HySack sack)
+{
+    HyQuery q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_GLOB, "pkg0001*");
+    return run_query(q);
+}
+
+static int
+q_name_substr_icase(HySack sack)
+{
+    HyQuery q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_SUBSTR | HY_ICASE, "G00042");
+    return run_query(q);
+}
+
+static int
+q_arch_evr(HySack sack)
+{
+    HyQuery q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_ARCH, HY_EQ, "x86_64");
+    hy_query_filter(q, HY_PKG_EVR, HY_GT, "1.0-1");
+    return run_query(q);
+}
+
+static int
+q_evr_scan(HySack sack)
+{
+    HyQuery q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_EVR, HY_GT, "1.0-1");
+    return run_query(q);
+}
+
+static int
+q_provides(HySack sack)
+{
+    HyQuery q = hy_query_create(sack);
+    hy_query_filter_provides(q, HY_EQ, "libpkg000008.so.1()(64bit)", NULL);
+    return run_query(q);
+}
+
+static int
+q_requires(HySack sack)
+{
+    HyQuery q = hy_query_create(sack);
+    hy_query_filter_requires(q, HY_EQ, BENCHGEN_POPULAR_LIB, NULL);
+    return run_query(q);
+}
+
+static int
+chained(HySack sack, int flags)
+{
+    HyQuery q = hy_query_create_flags(sack, flags);
+    hy_query_filter(q, HY_PKG_NAME, HY_GLOB, "pkg0001*");
+    hy_query_filter(q, HY_PKG_ARCH, HY_EQ, "x86_64");
+    hy_query_filter(q, HY_PKG_REPONAME, HY_NEQ, HY_SYSTEM_REPO_NAME);
+    hy_query_filter_requires(q, HY_NEQ, BENCHGEN_POPULAR_LIB, NULL);
+    return run_query(q);
+}
+
+static int
+q_chained(HySack sack)
+{
+    return chained(sack, 0);
+}
+
+/* the filters in the order they were given, each over the whole sack */
+static int
+q_chained_unplanned(HySack sack)
+{
+    return chained(sack, HY_NO_OPTIMIZE);
+}
+
+static int
+q_upgrades(HySack sack)
+{
+    HyQuery q = hy_query_create(sack);
+    hy_query_filter_upgrades(q, 1);
+    return run_query(q);
+}
+
+static int
+q_latest(HySack sack)
+{
+    HyQuery q = hy_query_create(sack);
+    hy_query_filter_latest(q, 1);
+    return run_query(q);
+}
+
+static int
+q_latest_per_arch(HySack sack)
+{
+    HyQuery q = hy_query_create(sack);
+    hy_query_filter_latest_per_arch(q, 1);
+    return run_query(q);
+}
+
+/* the sort-based latest filter hawkey used before, for comparison with
+   query_latest */
+static int
+latest_sortcmp(const void *ap, const void *bp, void *dp)
+{
+    Pool *pool = dp;
+    Solvable *sa = pool->solvables + *(Id *)ap;
+    Solvable *sb = pool->solvables + *(Id *)bp;
+    int r = sa->name - sb->name;
+    if (r)
+	return r;
+    return *(Id *)ap - *(Id *)bp;
+}
+
+static int
+q_latest_sorted(HySack sack)
+{
+    Pool *pool = sack_pool(sack);
+    Queue samename;
+    Map res;
+    Id hp = 0;
+
+    map_init(&res, pool->nsolvables);
+    queue_init(&samename);
+    for (Id p = 2; p < pool->nsolvables; ++p)
+	if (pool->solvables[p].repo) {
+	    MAPSET(&res, p);
+	    queue_push(&samename, p);
+	}
+    solv_sort(samename.elements, samename.count, sizeof(Id), latest_sortcmp,
+	      pool);
+    for (int i = 0; i < samename.count; ++i) {
+	Id p = samename.elements[i];
+	Solvable *s = pool->solvables + p, *highest = pool->solvables + hp;
+	if (!hp || highest->name != s->name) {
+	    hp = p;
+	} else if (pool_evrcmp(pool, highest->evr, s->evr, EVRCMP_COMPARE) < 0) {
+	    MAPCLR(&res, hp);
+	    hp = p;
+	} else {
+	    MAPCLR(&res, p);
+	}
+    }
+    queue_free(&samename);
+    map_free(&res);
+    return 0;
+}
+
+static int
+run_list(HySack sack)
+{
+    HyQuery q = hy_query_create(sack);
+    HyPackageList plist = hy_query_run(q);
+    int empty = hy_packagelist_count(plist) == 0;
+
+    hy_packagelist_free(plist);
+    hy_query_free(q);
+    return empty;
+}
+
+static int
+run_packed(HySack sack)
+{
+    HyQuery q = hy_query_create(sack);
+    HyPackageList plist = hy_query_run_packed(q);
+    int empty = hy_packagelist_count(plist) == 0;
+
+    hy_packagelist_free(plist);
+    hy_query_free(q);
+    return empty;
+}
+
+/* name, evr, arch, reponame and size of every package, one at a time */
+static int
+export_getters(HySack sack)
+{
+    HyQuery q = hy_query_create(sack);
+    HyPackageSet pset = hy_query_run_set(q);
+    const int count = hy_packageset_count(pset);
+    unsigned long long total = 0;
+
+    for (int i = 0; i < count; ++i) {
+	HyPackage pkg = hy_packageset_get_clone(pset, i);
+	char *nevra = hy_package_get_nevra(pkg);
+	total += strlen(hy_package_get_name(pkg)) +
+	    strlen(hy_package_get_evr(pkg)) + strlen(hy_package_get_arch(pkg)) +
+	    strlen(hy_package_get_reponame(pkg)) + strlen(nevra) +
+	    hy_package_get_size(pkg);
+	solv_free(nevra);
+	hy_package_free(pkg);
+    }
+    hy_packageset_free(pset);
+    hy_query_free(q);
+    return total == 0;
+}
+
+/* the same as one table */
+static int
+export_table(HySack sack)
+{
+    const int columns[] = {HY_COLUMN_NAME, HY_COLUMN_EVR, HY_COLUMN_ARCH,
+			   HY_COLUMN_REPONAME, HY_COLUMN_NEVRA, HY_COLUMN_SIZE};
+    HyQuery q = hy_query_create(sack);
+    HyPackageSet pset = hy_query_run_set(q);
+    HyPackageTable table = hy_packagetable_from_set(pset, columns, 6);
+    const unsigned long long *sizes = hy_packagetable_get_nums(table, 5);
+    unsigned long long total = 0;
+
+    for (int i = 0; i < hy_packagetable_count(table); ++i) {
+	for (int c = 0; c < 5; ++c)
+	    total += strlen(hy_packagetable_get_str(table, c, i));
+	total += sizes[i];
+    }
+    hy_packagetable_free(table);
+    hy_packageset_free(pset);
+    hy_query_free(q);
+    return total == 0;
+}
+
+static int
+bench_queries(struct _BenchCtx *ctx)
+{
+    const struct {
+	const char *name;
+	bench_query_fn fn;
+    } queries[] = {
+	{"query_name_eq", q_name_eq},
+	{"query_name_glob", q_name_glob},
+	{"query_name_substr_icase", q_name_substr_icase},
+	{"query_arch_evr", q_arch_evr},
+	{"query_evr_scan", q_evr_scan},
+	{"query_provides", q_provides},
+	{"query_requires", q_requires},
+	{"query_chained", q_chained},
+	{"query_chained_unplanned", q_chained_unplanned},
+	{"query_upgrades", q_upgrades},
+	{"query_latest", q_latest},
+	{"query_latest_sorted", q_latest_sorted},
+	{"query_latest_per_arch", q_latest_per_arch},
+	{"run_list", run_list},
+	{"run_packed", run_packed},
+	{"export_getters", export_getters},
+	{"export_table", export_table},
+    };
+    double ms[ctx->rounds];
+
+    for (unsigned i = 0; i < sizeof(queries) / sizeof(*queries); ++i) {
+	// the first run builds the lazy indexes
+	queries[i].fn(ctx->sack);
+	for (int r = 0; r < ctx->rounds; ++r) {
+	    double start = now();
+	    queries[i].fn(ctx->sack);
+	    ms[r] = (now() - start) * 1000;
+	}
+	report(ctx, queries[i].name, ctx->rounds, ms);
+    }
+    return 0;
+}
+
+static int
+bench_goal(struct _BenchCtx *ctx)
+{
+    const int rounds = ctx->rounds / 5 > 0 ? ctx->rounds / 5 : 1;
+    double ms[rounds];
+
+    for (int i = 0; i < rounds; ++i) {
+	HyGoal goal = hy_goal_create(ctx->sack);
+	double start = now();
+	hy_goal_upgrade_all(goal);
+	int ret = hy_goal_run(goal);
+	ms[i] = (now() - start) * 1000;
+	hy_goal_free(goal);
+	if (ret) {
+	    fprintf(stderr, "upgrade_all failed\n");
+	    return 1;
+	}
+    }
+    report(ctx, "goal_upgrade_all", rounds, ms);
+    return 0;
+}
+
+/* an upgrade of everything with installonly packages over the limit. the
+   installed packages with updates stand in for the kernels. */
+static int
+bench_goal_installonly(struct _BenchCtx *ctx, const char *name, int flags)
+{
+    const int rounds = ctx->rounds / 5 > 0 ? ctx->rounds / 5 : 1;
+    const int nonlies = 32;
+    const char *onlies[nonlies + 1];
+    double ms[rounds];
+    int n = 0, ret = 0;
+
+    HyQuery q = hy_query_create(ctx->sack);
+    hy_query_filter(q, HY_PKG_REPONAME, HY_EQ, HY_SYSTEM_REPO_NAME);
+    hy_query_filter_upgradable(q, 1);
+    HyPackageList plist = hy_query_run(q);
+    for (int i = 0; i < hy_packagelist_count(plist) && n < nonlies; ++i)
+	onlies[n++] = hy_package_get_name(hy_packagelist_get(plist, i));
+    onlies[n] = NULL;
+    hy_sack_set_installonly(ctx->sack, onlies);
+    hy_sack_set_installonly_limit(ctx->sack, 1);
+    hy_packagelist_free(plist);
+    hy_query_free(q);
+
+    for (int i = 0; i < rounds && !ret; ++i) {
+	HyGoal goal = hy_goal_create(ctx->sack);
+	double start = now();
+	hy_goal_upgrade_all(goal);
+	ret = hy_goal_run_flags(goal, flags);
+	ms[i] = (now() - start) * 1000;
+	hy_goal_free(goal);
+    }
+    hy_sack_set_installonly(ctx->sack, NULL);
+    hy_sack_set_installonly_limit(ctx->sack, 0);
+    if (ret) {
+	fprintf(stderr, "%s failed\n", name);
+	return 1;
+    }
+    report(ctx, name, rounds, ms);
+    return 0;
+}
+
+/* one goal per candidate package, each solved on its own. with a solver
+   cache the goals reuse the solvers of the previous ones. */
+static int
+bench_goal_candidates(struct _BenchCtx *ctx, const char *name, int nsolvers)
+{
+    const int rounds = ctx->rounds / 5 > 0 ? ctx->rounds / 5 : 1;
+    const int ngoals = 24;
+    int nnames = ctx->nsolvables * 2 / 3;
+    double ms[rounds];
+    char pkgname[32];
+    int ret = 0;
+
+    hy_sack_set_solver_cache_size(ctx->sack, nsolvers);
+    for (int i = 0; i < rounds; ++i) {
+	double start = now();
+	for (int g = 0; g < ngoals && !ret; ++g) {
+	    HyGoal goal = hy_goal_create(ctx->sack);
+	    HySelector sltr = hy_selector_create(ctx->sack);
+	    snprintf(pkgname, sizeof(pkgname), "pkg%06d",
+		     g * (nnames / ngoals));
+	    hy_selector_set(sltr, HY_PKG_NAME, HY_EQ, pkgname);
+	    ret = hy_goal_install_selector(goal, sltr) || hy_goal_run(goal);
+	    hy_selector_free(sltr);
+	    hy_goal_free(goal);
+	}
+	ms[i] = (now() - start) * 1000;
+    }
+    hy_sack_set_solver_cache_size(ctx->sack, 0);
+    if (ret) {
+	fprintf(stderr, "%s failed\n", name);
+	return 1;
+    }
+    report(ctx, name, rounds, ms);
+    return 0;
+}
+
+static int
+bench_provides_ready(struct _BenchCtx *ctx, const char *avail_fn,
+		     const char *system_fn)
+{
+    const int rounds = ctx->rounds / 5 > 0 ? ctx->rounds / 5 : 1;
+    double ms[rounds];
+
+    for (int i = 0; i < rounds; ++i) {
+	HySack sack = create_sack(ctx->dir);
+	Pool *pool = sack_pool(sack);
+	if (load_repo(pool, HY_SYSTEM_REPO_NAME, system_fn, 1) ||
+	    load_repo(pool, "bench", avail_fn, 0))
+	    return 1;
+	double start = now();
+	sack_make_provides_ready(sack);
+	ms[i] = (now() - start) * 1000;
+	hy_sack_free(sack);
+    }
+    report(ctx, "sack_make_provides_ready", rounds, ms);
+    return 0;
+}
+
+static int
+bench_size(struct _BenchCtx *ctx)
+{
+    Pool *pool = sack_pool(ctx->sack);
+    char system_fn[4096], avail_fn[4096];
+    int ret = 0;
+
+    snprintf(system_fn, sizeof(system_fn), "%s/system.repo", ctx->dir);
+    snprintf(avail_fn, sizeof(avail_fn), "%s/bench.repo", ctx->dir);
+
+    if (benchgen_write_testcase(system_fn, ctx->nsolvables, 1) ||
+	benchgen_write_testcase(avail_fn, ctx->nsolvables, 0) ||
+	load_repo(pool, HY_SYSTEM_REPO_NAME, system_fn, 1) ||
+	load_repo(pool, "bench", avail_fn, 0)) {
+	fprintf(stderr, "can not set up the repos in %s\n", ctx->dir);
+	return 1;
+    }
+
+    ret |= bench_load(ctx);
+    ret |= bench_provides_ready(ctx, avail_fn, system_fn);
+    ret |= bench_queries(ctx);
+    ret |= bench_goal(ctx);
+    ret |= bench_goal_installonly(ctx, "goal_installonly_resolve", 0);
+    ret |= bench_goal_installonly(ctx, "goal_installonly_planned",
+				  HY_PLAN_INSTALLONLY);
+    ret |= bench_goal_candidates(ctx, "goal_candidates_cold", 0);
+    ret |= bench_goal_candidates(ctx, "goal_candidates_warm", 1);
+    return ret;
+}
+
+int
+main(int argc, char **argv)
+{
+    struct _BenchCtx ctx = {.out = stdout, .rounds = 20, .query_threads = 1};
+    int default_sizes[] = {10000, 100000};
+    int opt, ret = 0;
+
+    while ((opt = getopt(argc, argv, "o:r:t:")) != -1) {
+	switch (opt) {
+	case 'o':
+	    ctx.out = fopen(optarg, "w");
+	    if (ctx.out == NULL) {
+		perror(optarg);
+		return 1;
+	    }
+	    break;
+	case 'r':
+	    ctx.rounds = atoi(optarg) > 0 ? atoi(optarg) : 1;
+	    break;
+	case 't':
+	    ctx.query_threads = atoi(optarg) > 0 ? atoi(optarg) : 1;
+	    break;
+	default:
+	    fprintf(stderr, "usage: %s [-o results.json] [-r rounds] "
+		    "[-t query threads] [nsolvables...]\n", argv[0]);
+	    return 1;
+	}
+    }
+
+    int nsizes = optind < argc ? argc - optind : 2;
+    fprintf(ctx.out, "{\n  \"hawkey\": \"%d.%d.%d\",\n  \"libsolv\": \"%s\",\n"
+	    "  \"query_threads\": %d,\n  \"results\": [", HY_VERSION_MAJOR,
+	    HY_VERSION_MINOR, HY_VERSION_PATCH, solv_version, ctx.query_threads);
+    for (int i = 0; i < nsizes; ++i) {
+	char tmpdir[] = UNITTEST_DIR;
+	ctx.nsolvables = optind < argc ? atoi(argv[optind + i]) :
+	    default_sizes[i];
+	if (mkdtemp(tmpdir) == NULL) {
+	    perror("mkdtemp");
+	    return 1;
+	}
+	ctx.dir = tmpdir;
+	ctx.sack = create_sack(tmpdir);
+	hy_sack_set_query_threads(ctx.sack, ctx.query_threads);
+	ret |= bench_size(&ctx);
+	hy_sack_free(ctx.sack);
+	nftw(tmpdir, rm_cb, 16, FTW_DEPTH | FTW_PHYS);
+    }
+    fprintf(ctx.out, "\n  ]\n}\n");
+    if (ctx.out != stdout)
+	fclose(ctx.out);
+    return ret;
+}
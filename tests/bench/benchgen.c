@@ -0,0 +1,328 @@
+/*
+ * Copyright (C) 2015 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "benchgen.h"
+
+#define MAX_DEPS 32
+#define LIB_EVERY 8
+#define TOOL_EVERY 50
+#define FILES_PER_PKG 24
+
+enum _dep_kind {
+    DEP_PROVIDES,
+    DEP_REQUIRES,
+    DEP_OBSOLETES,
+    DEP_CONFLICTS,
+    DEP_FILE
+};
+
+struct _BenchDep {
+    enum _dep_kind kind;
+    char name[48];
+    const char *op;	/* NULL for unversioned */
+    const char *ver;
+};
+
+struct _BenchPkg {
+    char name[16];
+    char ver[16];
+    const char *arch;
+    struct _BenchDep deps[MAX_DEPS];
+    int ndeps;
+};
+
+static const char *dep_tags[] = {"Prv", "Req", "Obs", "Con", "Prv"};
+static const char *dep_elements[] = {"provides", "requires", "obsoletes",
+				     "conflicts"};
+
+static unsigned
+rnd(unsigned *state)
+{
+    // xorshift32
+    unsigned x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static int
+name_count(int nsolvables)
+{
+    int nnames = nsolvables * 2 / 3;
+    return nnames > 0 ? nnames : 1;
+}
+
+static unsigned
+name_hash(int name)
+{
+    return (unsigned)name * 2654435761u;
+}
+
+static int
+is_installed(int name)
+{
+    return name_hash(name) % 3 == 0;
+}
+
+static void
+add_dep(struct _BenchPkg *pkg, enum _dep_kind kind, const char *op,
+	const char *ver, const char *fmt, int arg)
+{
+    if (pkg->ndeps == MAX_DEPS)
+	return;
+    struct _BenchDep *dep = pkg->deps + pkg->ndeps++;
+    dep->kind = kind;
+    snprintf(dep->name, sizeof(dep->name), fmt, arg);
+    dep->op = op;
+    dep->ver = ver;
+}
+
+/* most packages require a handful of others, few require a lot */
+static int
+requires_fanout(unsigned *state)
+{
+    unsigned r = rnd(state) % 100;
+    if (r < 40)
+	return rnd(state) % 3;
+    if (r < 80)
+	return 3 + rnd(state) % 4;
+    if (r < 95)
+	return 7 + rnd(state) % 6;
+    return 13 + rnd(state) % 8;
+}
+
+static void
+gen_package(int i, int nsolvables, struct _BenchPkg *pkg)
+{
+    static const char *arches[] = {"x86_64", "x86_64", "x86_64", "x86_64",
+				   "x86_64", "x86_64", "x86_64", "noarch",
+				   "noarch", "i686"};
+    int nnames = name_count(nsolvables);
+    int name = i % nnames;
+    unsigned state = (unsigned)i * 2246822519u + 1;
+
+    memset(pkg, 0, sizeof(*pkg));
+    snprintf(pkg->name, sizeof(pkg->name), "pkg%06d", name);
+    snprintf(pkg->ver, sizeof(pkg->ver), "1.%d", i / nnames);
+    pkg->arch = arches[name_hash(name) % 10];
+
+    if (name % LIB_EVERY == 0)
+	add_dep(pkg, DEP_PROVIDES, NULL, NULL, "libpkg%06d.so.1()(64bit)",
+		name);
+    if (name % TOOL_EVERY == 0)
+	add_dep(pkg, DEP_FILE, NULL, NULL, "/usr/bin/tool%06d", name);
+    for (int n = requires_fanout(&state); n > 0; --n) {
+	// skewed towards the low names, u^3 of a uniform u
+	double u = (rnd(&state) % 10000) / 10000.0;
+	int target = nnames * u * u * u;
+	if (target == name)
+	    continue;
+	if (rnd(&state) % 100 < 3)
+	    add_dep(pkg, DEP_REQUIRES, NULL, NULL, "/usr/bin/tool%06d",
+		    target - target % TOOL_EVERY);
+	else if (target % LIB_EVERY == 0)
+	    add_dep(pkg, DEP_REQUIRES, NULL, NULL, "libpkg%06d.so.1()(64bit)",
+		    target);
+	else if (rnd(&state) % 10 == 0)
+	    add_dep(pkg, DEP_REQUIRES, ">=", "1.0", "pkg%06d", target);
+	else
+	    add_dep(pkg, DEP_REQUIRES, NULL, NULL, "pkg%06d", target);
+    }
+    if (name % 100 == 1)
+	add_dep(pkg, DEP_OBSOLETES, NULL, NULL, "oldpkg%06d", name);
+    if (name % 200 == 2)
+	add_dep(pkg, DEP_CONFLICTS, "<", "1.0", "pkg%06d", (name + 1) % nnames);
+}
+
+int
+benchgen_write_testcase(const char *fn, int nsolvables, int installed)
+{
+    FILE *fp = fopen(fn, "w");
+    struct _BenchPkg pkg;
+    int nnames = name_count(nsolvables);
+
+    if (fp == NULL)
+	return 1;
+    fprintf(fp, "=Ver: 2.0\n");
+    for (int i = 0; i < (installed ? nnames : nsolvables); ++i) {
+	if (installed && !is_installed(i))
+	    continue;
+	gen_package(i, nsolvables, &pkg);
+	fprintf(fp, "=Pkg: %s %s 1 %s\n", pkg.name, pkg.ver, pkg.arch);
+	for (int j = 0; j < pkg.ndeps; ++j) {
+	    struct _BenchDep *dep = pkg.deps + j;
+	    if (dep->op)
+		fprintf(fp, "=%s: %s %s %s\n", dep_tags[dep->kind], dep->name,
+			dep->op, dep->ver);
+	    else
+		fprintf(fp, "=%s: %s\n", dep_tags[dep->kind], dep->name);
+	}
+    }
+    return fclose(fp) != 0;
+}
+
+static const char *
+op2flags(const char *op)
+{
+    return !strcmp(op, ">=") ? "GE" : "LT";
+}
+
+static void
+write_primary_package(FILE *fp, int i, struct _BenchPkg *pkg)
+{
+    fprintf(fp, "<package type=\"rpm\">\n"
+	    "  <name>%s</name>\n"
+	    "  <arch>%s</arch>\n"
+	    "  <version epoch=\"0\" ver=\"%s\" rel=\"1\"/>\n"
+	    "  <checksum type=\"sha256\" pkgid=\"YES\">%064x</checksum>\n"
+	    "  <summary>Synthetic package %d.</summary>\n"
+	    "  <description>Generated for the benchmarks.</description>\n"
+	    "  <time file=\"1400000000\" build=\"1400000000\"/>\n"
+	    "  <size package=\"%d\" installed=\"%d\" archive=\"%d\"/>\n"
+	    "  <location href=\"Packages/%s-%s-1.%s.rpm\"/>\n"
+	    "  <format>\n"
+	    "    <rpm:sourcerpm>%s-%s-1.src.rpm</rpm:sourcerpm>\n",
+	    pkg->name, pkg->arch, pkg->ver, i, i, 1000 + i, 4000 + i,
+	    2000 + i, pkg->name, pkg->ver, pkg->arch, pkg->name, pkg->ver);
+    for (int kind = DEP_PROVIDES; kind <= DEP_CONFLICTS; ++kind) {
+	int open = 0;
+	if (kind == DEP_PROVIDES) {
+	    fprintf(fp, "    <rpm:provides>\n"
+		    "      <rpm:entry name=\"%s\" flags=\"EQ\" epoch=\"0\" "
+		    "ver=\"%s\" rel=\"1\"/>\n", pkg->name, pkg->ver);
+	    open = 1;
+	}
+	for (int j = 0; j < pkg->ndeps; ++j) {
+	    struct _BenchDep *dep = pkg->deps + j;
+	    if (dep->kind != kind)
+		continue;
+	    if (!open)
+		fprintf(fp, "    <rpm:%s>\n", dep_elements[kind]);
+	    open = 1;
+	    if (dep->op)
+		fprintf(fp, "      <rpm:entry name=\"%s\" flags=\"%s\" "
+			"epoch=\"0\" ver=\"%s\"/>\n", dep->name,
+			op2flags(dep->op), dep->ver);
+	    else
+		fprintf(fp, "      <rpm:entry name=\"%s\"/>\n", dep->name);
+	}
+	if (open)
+	    fprintf(fp, "    </rpm:%s>\n", dep_elements[kind]);
+    }
+    // file provides are only known from the primary file lists
+    for (int j = 0; j < pkg->ndeps; ++j)
+	if (pkg->deps[j].kind == DEP_FILE)
+	    fprintf(fp, "    <file>%s</file>\n", pkg->deps[j].name);
+    fprintf(fp, "  </format>\n</package>\n");
+}
+
+/* the package's files besides its file provides, spread over a few
+   directories like those of a real package */
+static void
+write_filelists_package(FILE *fp, int i, struct _BenchPkg *pkg)
+{
+    static const char *dirs[] = {"/usr/lib64/%s/file%02d.so",
+				 "/usr/share/%s/data%02d",
+				 "/usr/share/doc/%s/README.%02d",
+				 "/usr/share/locale/xx%02d/LC_MESSAGES/%s.mo"};
+
+    fprintf(fp, "<package pkgid=\"%064x\" name=\"%s\" arch=\"%s\">\n"
+	    "  <version epoch=\"0\" ver=\"%s\" rel=\"1\"/>\n",
+	    i, pkg->name, pkg->arch, pkg->ver);
+    for (int j = 0; j < pkg->ndeps; ++j)
+	if (pkg->deps[j].kind == DEP_FILE)
+	    fprintf(fp, "  <file>%s</file>\n", pkg->deps[j].name);
+    for (int j = 0; j < FILES_PER_PKG; ++j) {
+	fprintf(fp, "  <file>");
+	if (j % 4 == 3)
+	    fprintf(fp, dirs[3], j, pkg->name);
+	else
+	    fprintf(fp, dirs[j % 4], pkg->name, j);
+	fprintf(fp, "</file>\n");
+    }
+    fprintf(fp, "</package>\n");
+}
+
+int
+benchgen_write_yum(const char *dir, int nsolvables)
+{
+    char fn[4096];
+    struct _BenchPkg pkg;
+    FILE *fp;
+    int ret = 0;
+
+    snprintf(fn, sizeof(fn), "%s/repodata", dir);
+    if (mkdir(fn, 0777) && errno != EEXIST)
+	return 1;
+
+    snprintf(fn, sizeof(fn), "%s/repodata/primary.xml", dir);
+    if ((fp = fopen(fn, "w")) == NULL)
+	return 1;
+    fprintf(fp, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	    "<metadata xmlns=\"http://linux.duke.edu/metadata/common\" "
+	    "xmlns:rpm=\"http://linux.duke.edu/metadata/rpm\" "
+	    "packages=\"%d\">\n", nsolvables);
+    for (int i = 0; i < nsolvables; ++i) {
+	gen_package(i, nsolvables, &pkg);
+	write_primary_package(fp, i, &pkg);
+    }
+    fprintf(fp, "</metadata>\n");
+    ret |= fclose(fp) != 0;
+
+    snprintf(fn, sizeof(fn), "%s/repodata/filelists.xml", dir);
+    if ((fp = fopen(fn, "w")) == NULL)
+	return 1;
+    fprintf(fp, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	    "<filelists xmlns=\"http://linux.duke.edu/metadata/filelists\" "
+	    "packages=\"%d\">\n", nsolvables);
+    for (int i = 0; i < nsolvables; ++i) {
+	gen_package(i, nsolvables, &pkg);
+	write_filelists_package(fp, i, &pkg);
+    }
+    fprintf(fp, "</filelists>\n");
+    ret |= fclose(fp) != 0;
+
+    snprintf(fn, sizeof(fn), "%s/repodata/repomd.xml", dir);
+    if ((fp = fopen(fn, "w")) == NULL)
+	return 1;
+    fprintf(fp, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+	    "<repomd xmlns=\"http://linux.duke.edu/metadata/repo\" "
+	    "xmlns:rpm=\"http://linux.duke.edu/metadata/rpm\">\n"
+	    " <revision>%d</revision>\n"
+	    "<data type=\"primary\">\n"
+	    "  <location href=\"repodata/primary.xml\"/>\n"
+	    "  <timestamp>1400000000</timestamp>\n"
+	    "</data>\n"
+	    "<data type=\"filelists\">\n"
+	    "  <location href=\"repodata/filelists.xml\"/>\n"
+	    "  <timestamp>1400000000</timestamp>\n"
+	    "</data>\n"
+	    "</repomd>\n", nsolvables);
+    ret |= fclose(fp) != 0;
+    return ret;
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2015 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef BENCHGEN_H
+#define BENCHGEN_H
+
+/*
+ * Synthetic distribution for the benchmarks. Package i of a repo with
+ * nsolvables packages is always generated the same: about 1.5 packages per
+ * name "pkg%06d" in increasing versions, library and file provides, and
+ * requires whose fan-out and targets follow a long tail, so few libraries
+ * are required by many packages.
+ */
+
+#define BENCHGEN_POPULAR_LIB "libpkg000000.so.1()(64bit)"
+
+/* write the available packages in the testcase format. with installed set,
+   write the system repo instead: the oldest version of every third name */
+int benchgen_write_testcase(const char *fn, int nsolvables, int installed);
+/* write the available packages as a yum repo: dir/repodata/repomd.xml,
+   dir/repodata/primary.xml and dir/repodata/filelists.xml */
+int benchgen_write_yum(const char *dir, int nsolvables);
+
+#endif
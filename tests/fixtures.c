@@ -171,8 +171,11 @@ void fixture_reset(void)
     hy_sack_set_installonly(sack, NULL);
     hy_sack_set_installonly_limit(sack, 0);
     hy_sack_set_excludes(sack, NULL);
+    hy_sack_set_includes(sack, NULL);
     hy_sack_repo_enabled(sack, "main", 1);
     hy_sack_repo_enabled(sack, "updates", 1);
+    hy_sack_set_query_cache_size(sack, 0);
+    hy_sack_set_solver_cache_size(sack, 0);
 }
 
 void setup_yum_sack(HySack sack, const char *yum_repo_name)
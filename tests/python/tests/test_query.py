@@ -53,6 +53,15 @@ class TestQuery(base.TestCase):
         q.filterm(name__eq=[u"flying", "penny"])
         self.assertEqual(q.count(), 2)
 
+    def test_columns(self):
+        q = hawkey.Query(self.sack).filter(name=["flying", "penny"])
+        (names, evrs, epochs) = q.columns("name", "evr", "epoch")
+        pkgs = q.run()
+        self.assertEqual(names, [p.name for p in pkgs])
+        self.assertEqual(evrs, [p.evr for p in pkgs])
+        self.assertEqual(epochs, [p.epoch for p in pkgs])
+        self.assertRaises(hawkey.ValueException, q.columns, "flying")
+
     def test_count(self):
         q = hawkey.Query(self.sack).filter(name=["flying", "penny"])
 
@@ -197,6 +206,15 @@ class TestQuery(base.TestCase):
         q = hawkey.Query(self.sack).filter(name="jay")
         self.assertLength(q.run(), 2)
 
+    def test_edit(self):
+        self.sack.begin_edit()
+        self.sack.disable_repo(hawkey.SYSTEM_REPO_NAME)
+        self.sack.end_edit()
+        q = hawkey.Query(self.sack).filter(name="jay")
+        self.assertLength(q.run(), 0)
+        self.sack.enable_repo(hawkey.SYSTEM_REPO_NAME)
+        self.assertRaises(hawkey.ValueException, self.sack.end_edit)
+
     def test_multiple_flags(self):
         q = hawkey.Query(self.sack).filter(name__glob__not=["p*", "j*"])
         self.assertItemsEqual(list(map(lambda p: p.name, q.run())),
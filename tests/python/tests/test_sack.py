@@ -47,6 +47,14 @@ class TestSackTest(base.TestCase):
         self.assertEqual(len(sack), hawkey.test.EXPECT_YUM_NSOLVABLES +
                          hawkey.test.EXPECT_SYSTEM_NSOLVABLES)
 
+    def test_freeze(self):
+        sack = base.TestSack(repo_dir=self.repo_dir)
+        sack.load_system_repo()
+        sack.load_yum_repo(build_cache=True)
+        sack.freeze()
+        q = hawkey.Query(sack).filter(name="tour")
+        self.assertLength(q.run(), 1)
+
     def test_cache_dir(self):
         sack = base.TestSack(repo_dir=self.repo_dir)
         self.assertTrue(sack.cache_dir.startswith("/tmp/pyhawkey"))
@@ -75,6 +83,12 @@ class BasicTest(unittest.TestCase):
         self.assertRaises(IOError, sack.load_yum_repo, repo)
         sack = hawkey.Sack()
 
+    def test_failed_load_repos(self):
+        sack = hawkey.Sack(cachedir=base.cachedir)
+        repos = [hawkey.Repo("name"), hawkey.Repo("other")]
+        self.assertRaises(IOError, sack.load_yum_repos, repos, nthreads=2)
+        self.assertRaises(TypeError, sack.load_yum_repos, 5)
+
     def test_unicoded_cachedir(self):
         # does not raise UnicodeEncodeError
         hawkey.Sack(cachedir=u"unicod\xe9")
@@ -24,6 +24,7 @@
 // hawkey
 #include "src/errno.h"
 #include "src/goal.h"
+#include "src/goal_internal.h"
 #include "src/iutil.h"
 #include "src/package_internal.h"
 #include "src/packageset.h"
@@ -437,6 +438,35 @@ START_TEST(test_goal_upgrade_all)
 }
 END_TEST
 
+START_TEST(test_goal_result_set)
+{
+    HyPackageList (*lists[])(HyGoal) = {
+	hy_goal_list_erasures, hy_goal_list_installs, hy_goal_list_obsoleted,
+	hy_goal_list_reinstalls, hy_goal_list_upgrades, hy_goal_list_downgrades
+    };
+    HyGoal goal = hy_goal_create(test_globals.sack);
+    fail_unless(hy_goal_get_result_set(goal, HY_RESULT_INSTALLS) == NULL);
+    fail_unless(hy_get_errno() == HY_E_OP);
+    hy_goal_upgrade_all(goal);
+    fail_if(hy_goal_run(goal));
+
+    for (int which = 0; which < _HY_RESULT_NUM; ++which) {
+	HyPackageSet pset = hy_goal_get_result_set(goal, which);
+	HyPackageList plist = lists[which](goal);
+	ck_assert_int_eq(hy_packageset_count(pset),
+			 hy_packagelist_count(plist));
+	for (int i = 0; i < hy_packagelist_count(plist); ++i)
+	    fail_unless(hy_packageset_has(pset, hy_packagelist_get(plist, i)));
+	hy_packagelist_free(plist);
+	hy_packageset_free(pset);
+    }
+    HyPackageSet pset = hy_goal_get_result_set(goal, HY_RESULT_OBSOLETED);
+    fail_unless(hy_packageset_count(pset) > 0);
+    hy_packageset_free(pset);
+    hy_goal_free(goal);
+}
+END_TEST
+
 START_TEST(test_goal_downgrade)
 {
     HySack sack = test_globals.sack;
@@ -735,6 +765,138 @@ START_TEST(test_goal_upgrade_disabled_repo)
 }
 END_TEST
 
+START_TEST(test_goal_solver_cache)
+{
+    HySack sack = test_globals.sack;
+    HyPackage pkg = by_name_repo(sack, "penny-lib", HY_SYSTEM_REPO_NAME);
+
+    hy_sack_set_solver_cache_size(sack, 1);
+    HyGoal goal = hy_goal_create(sack);
+    hy_goal_erase(goal, pkg);
+    fail_if(hy_goal_run_flags(goal, HY_ALLOW_UNINSTALL));
+    assert_iueo(goal, 0, 0, 2, 0);
+    hy_goal_free(goal);
+
+    // the cached solver must not keep allowing uninstalls
+    goal = hy_goal_create(sack);
+    hy_goal_erase(goal, pkg);
+    fail_unless(hy_goal_run(goal));
+    fail_unless(hy_goal_count_problems(goal) > 0);
+    // and the same goal can solve again in it
+    fail_if(hy_goal_run_flags(goal, HY_ALLOW_UNINSTALL));
+    assert_iueo(goal, 0, 0, 2, 0);
+    hy_goal_free(goal);
+
+    hy_package_free(pkg);
+}
+END_TEST
+
+START_TEST(test_goal_run_batch)
+{
+    HySack sack = test_globals.sack;
+    HyPackage walrus = get_latest_pkg(sack, "walrus");
+    HyPackage penny = by_name_repo(sack, "penny-lib", HY_SYSTEM_REPO_NAME);
+    HyGoal goals[4];
+
+    for (int i = 0; i < 4; ++i) {
+	goals[i] = hy_goal_create(sack);
+	if (i % 2)
+	    hy_goal_erase(goals[i], penny);
+	else
+	    hy_goal_install(goals[i], walrus);
+    }
+    fail_if(hy_sack_freeze(sack));
+    // erasing penny-lib fails, flying depends on it
+    ck_assert_int_eq(hy_goal_run_batch(goals, 4, 0, 3), 2);
+    for (int i = 0; i < 4; ++i) {
+	if (i % 2)
+	    fail_unless(hy_goal_count_problems(goals[i]) > 0);
+	else
+	    assert_iueo(goals[i], 2, 0, 0, 0);
+    }
+    ck_assert_int_eq(hy_goal_run_batch(goals + 1, 1, HY_ALLOW_UNINSTALL, 3),
+		     0);
+    assert_iueo(goals[1], 0, 0, 2, 0);
+
+    for (int i = 0; i < 4; ++i)
+	hy_goal_free(goals[i]);
+    hy_package_free(walrus);
+    hy_package_free(penny);
+}
+END_TEST
+
+START_TEST(test_goal_run_batch_debugmask)
+{
+    HySack sack = test_globals.sack;
+    Pool *pool = sack_pool(sack);
+    HyPackage walrus = get_latest_pkg(sack, "walrus");
+    HyGoal goals[8];
+    int debugmask = pool->debugmask;
+
+    // the default mask has libsolv print the results through tmpspace
+    fail_unless(debugmask & SOLV_DEBUG_RESULT);
+    for (int i = 0; i < 8; ++i) {
+	goals[i] = hy_goal_create(sack);
+	hy_goal_install(goals[i], walrus);
+    }
+    fail_if(hy_sack_freeze(sack));
+    fail_unless(sack_frozen(sack));
+    ck_assert_int_eq(hy_goal_run_batch(goals, 8, 0, 4), 0);
+    for (int i = 0; i < 8; ++i)
+	assert_iueo(goals[i], 2, 0, 0, 0);
+    ck_assert_int_eq(pool->debugmask, debugmask);
+
+    for (int i = 0; i < 8; ++i)
+	hy_goal_free(goals[i]);
+    hy_package_free(walrus);
+}
+END_TEST
+
+START_TEST(test_goal_run_batch_selectors)
+{
+    HySack sack = test_globals.sack;
+    Pool *pool = sack_pool(sack);
+    HyGoal goals[6];
+
+    // the selectors add to a frozen pool
+    fail_if(hy_sack_freeze(sack));
+    for (int i = 0; i < 6; ++i) {
+	HySelector sltr = hy_selector_create(sack);
+	goals[i] = hy_goal_create(sack);
+	if (i % 2) {
+	    fail_if(hy_selector_set(sltr, HY_PKG_NAME, HY_EQ, "dog"));
+	    fail_if(hy_selector_set(sltr, HY_PKG_EVR, HY_EQ, "1-2"));
+	    fail_if(hy_goal_upgrade_to_selector(goals[i], sltr));
+	} else {
+	    fail_if(hy_selector_set(sltr, HY_PKG_NAME, HY_EQ, "semolina"));
+	    fail_if(hy_selector_set(sltr, HY_PKG_ARCH, HY_EQ, "i686"));
+	    fail_if(hy_goal_install_selector(goals[i], sltr));
+	}
+	hy_selector_free(sltr);
+    }
+    fail_unless(sack_frozen(sack));
+    // the solves will only read the providers of the new relations
+    Id dog = pool_rel2id(pool, pool_str2id(pool, "dog", 0),
+			 pool_str2id(pool, "1-2", 0), REL_EQ, 0);
+    Id semolina = pool_rel2id(pool, pool_str2id(pool, "semolina", 0),
+			      pool_str2id(pool, "i686", 0), REL_ARCH, 0);
+    fail_unless(dog && pool->whatprovides_rel[GETRELID(dog)]);
+    fail_unless(semolina && pool->whatprovides_rel[GETRELID(semolina)]);
+    ck_assert_int_eq(hy_goal_run_batch(goals, 6, 0, 3), 0);
+    for (int i = 0; i < 6; ++i) {
+	HyPackageList plist = i % 2 ? hy_goal_list_upgrades(goals[i]) :
+	    hy_goal_list_installs(goals[i]);
+	ck_assert_int_eq(hy_packagelist_count(plist), 1);
+	assert_nevra_eq(hy_packagelist_get(plist, 0), i % 2 ?
+			"dog-1-2.x86_64" : "semolina-2-0.i686");
+	hy_packagelist_free(plist);
+    }
+
+    for (int i = 0; i < 6; ++i)
+	hy_goal_free(goals[i]);
+}
+END_TEST
+
 START_TEST(test_goal_describe_problem_excludes)
 {
     HySack sack = test_globals.sack;
@@ -970,6 +1132,10 @@ START_TEST(test_goal_run_all)
 }
 END_TEST
 
+/* the installonly limit tests run once enforcing the limit after the first
+   solve and once planning it ahead, which must get by with a single solve */
+static const int installonly_limit_flags[] = {0, HY_PLAN_INSTALLONLY};
+
 START_TEST(test_goal_installonly_limit)
 {
     const char *installonly[] = {"k", NULL};
@@ -980,9 +1146,11 @@ START_TEST(test_goal_installonly_limit)
 
     HyGoal goal = hy_goal_create(sack);
     hy_goal_upgrade_all(goal);
-    fail_if(hy_goal_run_flags(goal, 0));
+    fail_if(hy_goal_run_flags(goal, installonly_limit_flags[_i]));
+    ck_assert_int_eq(goal_nsolves(goal), _i ? 1 : 2);
 
-    assert_iueo(goal, 1, 1, 3, 0); // k-m is just upgraded
+    // k-m is just upgraded, k-3-6.i686 is left out as no k.i686 is installed
+    assert_iueo(goal, 1, 1, 3, 0);
     HyPackageList erasures = hy_goal_list_erasures(goal);
     assert_nevra_eq(hy_packagelist_get(erasures, 0), "k-1-0.x86_64");
     assert_nevra_eq(hy_packagelist_get(erasures, 1), "k-freak-1-0-1-0.x86_64");
@@ -1005,7 +1173,8 @@ START_TEST(test_goal_installonly_limit_disabled)
 
     HyGoal goal = hy_goal_create(sack);
     hy_goal_upgrade_all(goal);
-    fail_if(hy_goal_run_flags(goal, 0));
+    fail_if(hy_goal_run_flags(goal, installonly_limit_flags[_i]));
+    ck_assert_int_eq(goal_nsolves(goal), 1);
 
     assert_iueo(goal, 1, 1, 0, 0);
     hy_goal_free(goal);
@@ -1023,7 +1192,8 @@ START_TEST(test_goal_installonly_limit_running_kernel)
 
     HyGoal goal = hy_goal_create(sack);
     hy_goal_upgrade_all(goal);
-    fail_if(hy_goal_run_flags(goal, 0));
+    fail_if(hy_goal_run_flags(goal, installonly_limit_flags[_i]));
+    ck_assert_int_eq(goal_nsolves(goal), _i ? 1 : 2);
 
     assert_iueo(goal, 1, 1, 3, 0);
     HyPackageList erasures = hy_goal_list_erasures(goal);
@@ -1047,7 +1217,8 @@ START_TEST(test_goal_installonly_limit_with_modules)
 
     HyGoal goal = hy_goal_create(sack);
     hy_goal_upgrade_all(goal);
-    fail_if(hy_goal_run_flags(goal, 0));
+    fail_if(hy_goal_run_flags(goal, installonly_limit_flags[_i]));
+    ck_assert_int_eq(goal_nsolves(goal), _i ? 1 : 2);
 
     assert_iueo(goal, 2, 0, 5, 0);
     HyPackageList erasures = hy_goal_list_erasures(goal);
@@ -1147,6 +1318,7 @@ goal_suite(void)
     tcase_add_test(tc, test_goal_selector_upgrade_provides);
     tcase_add_test(tc, test_goal_upgrade);
     tcase_add_test(tc, test_goal_upgrade_all);
+    tcase_add_test(tc, test_goal_result_set);
     tcase_add_test(tc, test_goal_downgrade);
     tcase_add_test(tc, test_goal_get_reason);
     tcase_add_test(tc, test_goal_get_reason_selector);
@@ -1168,6 +1340,10 @@ goal_suite(void)
     tcase_add_test(tc, test_goal_upgrade_all_excludes);
     tcase_add_test(tc, test_goal_upgrade_disabled_repo);
     tcase_add_test(tc, test_goal_describe_problem_excludes);
+    tcase_add_test(tc, test_goal_solver_cache);
+    tcase_add_test(tc, test_goal_run_batch);
+    tcase_add_test(tc, test_goal_run_batch_debugmask);
+    tcase_add_test(tc, test_goal_run_batch_selectors);
     suite_add_tcase(s, tc);
 
     tc = tcase_create("Main");
@@ -1189,10 +1365,10 @@ goal_suite(void)
     tc = tcase_create("Installonly");
     tcase_add_unchecked_fixture(tc, fixture_installonly, teardown);
     tcase_add_checked_fixture(tc, fixture_reset, NULL);
-    tcase_add_test(tc, test_goal_installonly_limit);
-    tcase_add_test(tc, test_goal_installonly_limit_disabled);
-    tcase_add_test(tc, test_goal_installonly_limit_running_kernel);
-    tcase_add_test(tc, test_goal_installonly_limit_with_modules);
+    tcase_add_loop_test(tc, test_goal_installonly_limit, 0, 2);
+    tcase_add_loop_test(tc, test_goal_installonly_limit_disabled, 0, 2);
+    tcase_add_loop_test(tc, test_goal_installonly_limit_running_kernel, 0, 2);
+    tcase_add_loop_test(tc, test_goal_installonly_limit_with_modules, 0, 2);
     suite_add_tcase(s, tc);
 
     tc = tcase_create("Vendor");
@@ -84,6 +84,7 @@ main(int argc, const char **argv)
     srunner_add_suite(sr, package_suite());
     srunner_add_suite(sr, packagelist_suite());
     srunner_add_suite(sr, packageset_suite());
+    srunner_add_suite(sr, packagetable_suite());
     srunner_add_suite(sr, query_suite());
     srunner_add_suite(sr, selector_suite());
     srunner_add_suite(sr, subject_suite());
@@ -117,6 +117,23 @@ START_TEST(test_versions)
 }
 END_TEST
 
+START_TEST(test_nevra)
+{
+    HySack sack = test_globals.sack;
+    HyPackage pkg = by_name(sack, "baby");
+    HyPackage pkg2 = by_name(sack, "baby");
+    char *nevra = hy_package_get_nevra(pkg);
+    const char *cached = hy_package_get_nevra_cached(pkg);
+
+    ck_assert_str_eq(nevra, "baby-6:5.0-11.x86_64");
+    ck_assert_str_eq(cached, nevra);
+    fail_unless(hy_package_get_nevra_cached(pkg2) == cached);
+    hy_free(nevra);
+    hy_package_free(pkg);
+    hy_package_free(pkg2);
+}
+END_TEST
+
 START_TEST(test_no_sourcerpm)
 {
     HySack sack = test_globals.sack;
@@ -349,6 +366,7 @@ package_suite(void)
     tcase_add_test(tc, test_package_summary);
     tcase_add_test(tc, test_identical);
     tcase_add_test(tc, test_versions);
+    tcase_add_test(tc, test_nevra);
     tcase_add_test(tc, test_no_sourcerpm);
     suite_add_tcase(s, tc);
 
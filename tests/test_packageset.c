@@ -134,6 +134,45 @@ START_TEST(test_get_clone)
 }
 END_TEST
 
+START_TEST(test_map_next)
+{
+    HySack sack = test_globals.sack;
+    Map map;
+    int max = sack_last_solvable(sack);
+
+    packageset_to_map(pset, &map);
+    fail_unless(map_next(&map, 0) == 0);
+    fail_unless(map_next(&map, 1) == 9);
+    fail_unless(map_next(&map, 10) == max);
+    fail_unless(map_next(&map, max + 1) == -1);
+    map_free(&map);
+
+    // long runs of clear bits are skipped a word at a time
+    Map m;
+    map_init(&m, 1000);
+    MAPSET(&m, 3);
+    MAPSET(&m, 700);
+    MAPSET(&m, 999);
+    fail_unless(map_next(&m, 4) == 700);
+    fail_unless(map_next(&m, 701) == 999);
+    fail_unless(map_next(&m, 1000) == -1);
+    map_free(&m);
+}
+END_TEST
+
+START_TEST(test_clone_dense)
+{
+    HyPackageSet dense = packageset_clone_dense(pset);
+    Map *map = packageset_get_map(dense);
+
+    fail_unless(map_count(map) == 3);
+    fail_unless(MAPTST(map, 9));
+    // the original set is left alone
+    fail_unless(hy_packageset_count(pset) == 3);
+    hy_packageset_free(dense);
+}
+END_TEST
+
 START_TEST(test_get_pkgid)
 {
     HySack sack = test_globals.sack;
@@ -164,6 +203,121 @@ START_TEST(test_get_pkgid)
 }
 END_TEST
 
+static HyPackageSet
+all_packages(HySack sack)
+{
+    HyPackageSet all = hy_packageset_create(sack);
+    for (Id id = 0; id <= sack_last_solvable(sack); ++id)
+	hy_packageset_add(all, package_create(sack, id));
+    return all;
+}
+
+START_TEST(test_union)
+{
+    HySack sack = test_globals.sack;
+    int max = sack_last_solvable(sack);
+    HyPackageSet pset2 = hy_packageset_create(sack);
+
+    hy_packageset_add(pset2, package_create(sack, 8));
+    hy_packageset_add(pset2, package_create(sack, 9));
+    hy_packageset_union(pset2, pset);
+    fail_unless(hy_packageset_count(pset2) == 4);
+    fail_unless(packageset_get_pkgid(pset2, 1, -1) == 8);
+    fail_unless(packageset_get_pkgid(pset2, 3, -1) == max);
+
+    HyPackageSet all = all_packages(sack);
+    hy_packageset_union(pset2, all);
+    fail_unless(hy_packageset_count(pset2) == max + 1);
+    hy_packageset_free(all);
+    hy_packageset_free(pset2);
+}
+END_TEST
+
+START_TEST(test_intersect)
+{
+    HySack sack = test_globals.sack;
+    HyPackageSet all = all_packages(sack);
+    HyPackageSet pset2 = hy_packageset_clone(all);
+
+    hy_packageset_intersect(pset2, all);
+    fail_unless(hy_packageset_count(pset2) == sack_last_solvable(sack) + 1);
+    hy_packageset_intersect(pset2, pset);
+    fail_unless(hy_packageset_count(pset2) == 3);
+    fail_unless(packageset_get_pkgid(pset2, 1, -1) == 9);
+
+    HyPackageSet pset3 = hy_packageset_create(sack);
+    hy_packageset_add(pset3, package_create(sack, 9));
+    hy_packageset_add(pset3, package_create(sack, 10));
+    hy_packageset_intersect(pset2, pset3);
+    fail_unless(hy_packageset_count(pset2) == 1);
+    fail_unless(packageset_get_pkgid(pset2, 0, -1) == 9);
+
+    hy_packageset_free(pset3);
+    hy_packageset_free(pset2);
+    hy_packageset_free(all);
+}
+END_TEST
+
+START_TEST(test_difference)
+{
+    HySack sack = test_globals.sack;
+    int max = sack_last_solvable(sack);
+    HyPackageSet all = all_packages(sack);
+    HyPackageSet pset2 = hy_packageset_clone(pset);
+
+    hy_packageset_difference(all, pset);
+    fail_unless(hy_packageset_count(all) == max + 1 - 3);
+    fail_unless(packageset_get_pkgid(all, 0, -1) == 1);
+    hy_packageset_difference(pset2, all);
+    fail_unless(hy_packageset_count(pset2) == 3);
+    hy_packageset_difference(pset2, pset);
+    fail_unless(hy_packageset_count(pset2) == 0);
+
+    hy_packageset_free(pset2);
+    hy_packageset_free(all);
+}
+END_TEST
+
+struct _Collected {
+    Queue ids;
+    HyPackage kept;
+};
+
+static int
+collect_ids(HyPackage pkg, void *data)
+{
+    struct _Collected *c = data;
+    queue_push(&c->ids, package_id(pkg));
+    // the following calls must not change a package kept by the callback
+    if (c->ids.count == 2)
+	c->kept = hy_package_link(pkg);
+    return c->ids.count == 3;
+}
+
+START_TEST(test_iterate)
+{
+    HySack sack = test_globals.sack;
+    HyPackageSet all = all_packages(sack);
+    struct _Collected c = {.kept = NULL};
+
+    queue_init(&c.ids);
+    fail_unless(hy_packageset_iterate(all, collect_ids, &c) == 1);
+    fail_unless(c.ids.count == 3);
+    for (int i = 0; i < c.ids.count; ++i)
+	fail_unless(c.ids.elements[i] == i);
+    fail_unless(package_id(c.kept) == 1);
+    hy_package_free(c.kept);
+
+    queue_empty(&c.ids);
+    fail_unless(hy_packageset_iterate(pset, collect_ids, &c) == 1);
+    fail_unless(c.ids.elements[1] == 9);
+    fail_unless(c.ids.elements[2] == sack_last_solvable(sack));
+    hy_package_free(c.kept);
+    queue_free(&c.ids);
+    hy_packageset_free(all);
+}
+END_TEST
+
 Suite *
 packageset_suite(void)
 {
@@ -175,6 +329,12 @@ packageset_suite(void)
     tcase_add_test(tc, test_has);
     tcase_add_test(tc, test_get_clone);
     tcase_add_test(tc, test_get_pkgid);
+    tcase_add_test(tc, test_map_next);
+    tcase_add_test(tc, test_clone_dense);
+    tcase_add_test(tc, test_union);
+    tcase_add_test(tc, test_intersect);
+    tcase_add_test(tc, test_difference);
+    tcase_add_test(tc, test_iterate);
     suite_add_tcase(s, tc);
 
     return s;
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2015 Red Hat, Inc.
+ *
+ * Licensed under the GNU Lesser General Public License Version 2.1
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <check.h>
+#include <string.h>
+
+// libsolv
+#include <solv/util.h>
+
+// hawkey
+#include "src/package_internal.h"
+#include "src/packagelist.h"
+#include "src/packageset.h"
+#include "src/packagetable.h"
+#include "src/query.h"
+#include "fixtures.h"
+#include "testsys.h"
+#include "test_suites.h"
+
+static void
+assert_str_cell(HyPackageTable table, int column, int row, char *expected)
+{
+    const char *cell = hy_packagetable_get_str(table, column, row);
+
+    if (expected == NULL)
+	fail_unless(cell == NULL);
+    else
+	ck_assert_str_eq(cell, expected);
+    solv_free(expected);
+}
+
+START_TEST(test_columns)
+{
+    HySack sack = test_globals.sack;
+    const int columns[] = {HY_COLUMN_NAME, HY_COLUMN_EPOCH, HY_COLUMN_VERSION,
+			   HY_COLUMN_RELEASE, HY_COLUMN_ARCH, HY_COLUMN_NEVRA,
+			   HY_COLUMN_REPONAME, HY_COLUMN_SIZE,
+			   HY_COLUMN_SOURCERPM};
+    HyQuery q = hy_query_create(sack);
+    HyPackageSet pset = hy_query_run_set(q);
+    HyPackageTable table = hy_packagetable_from_set(pset, columns, 9);
+    const int count = hy_packageset_count(pset);
+
+    ck_assert_int_eq(hy_packagetable_count(table), count);
+    fail_unless(hy_packagetable_get_nums(table, 0) == NULL);
+    fail_unless(hy_packagetable_get_offsets(table, 1) == NULL);
+    for (int i = 0; i < count; ++i) {
+	HyPackage pkg = hy_packageset_get_clone(pset, i);
+	const unsigned long long *epochs = hy_packagetable_get_nums(table, 1);
+	const unsigned long long *sizes = hy_packagetable_get_nums(table, 7);
+
+	ck_assert_str_eq(hy_packagetable_get_str(table, 0, i),
+			 hy_package_get_name(pkg));
+	fail_unless(epochs[i] == hy_package_get_epoch(pkg));
+	assert_str_cell(table, 2, i, hy_package_get_version(pkg));
+	assert_str_cell(table, 3, i, hy_package_get_release(pkg));
+	ck_assert_str_eq(hy_packagetable_get_str(table, 4, i),
+			 hy_package_get_arch(pkg));
+	assert_str_cell(table, 5, i, hy_package_get_nevra(pkg));
+	ck_assert_str_eq(hy_packagetable_get_str(table, 6, i),
+			 hy_package_get_reponame(pkg));
+	fail_unless(sizes[i] == hy_package_get_size(pkg));
+	assert_str_cell(table, 8, i, hy_package_get_sourcerpm(pkg));
+	hy_package_free(pkg);
+    }
+
+    // names of the same Id share the arena
+    const int *names = hy_packagetable_get_offsets(table, 0);
+    for (int i = 1; i < count; ++i)
+	if (!strcmp(hy_packagetable_get_str(table, 0, i - 1),
+		    hy_packagetable_get_str(table, 0, i)))
+	    ck_assert_int_eq(names[i - 1], names[i]);
+
+    hy_packagetable_free(table);
+    hy_packageset_free(pset);
+    hy_query_free(q);
+}
+END_TEST
+
+START_TEST(test_from_list)
+{
+    HySack sack = test_globals.sack;
+    const int columns[] = {HY_COLUMN_EVR, HY_COLUMN_ID};
+    HyQuery q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "penny");
+    HyPackageList plist = hy_query_run(q);
+    HyPackageTable table = hy_packagetable_from_list(plist, columns, 2);
+    HyPackage pkg;
+    int i;
+
+    ck_assert_int_eq(hy_packagetable_count(table), 2);
+    FOR_PACKAGELIST(pkg, plist, i) {
+	ck_assert_str_eq(hy_packagetable_get_str(table, 0, i),
+			 hy_package_get_evr(pkg));
+	fail_unless(hy_packagetable_get_nums(table, 1)[i] == package_id(pkg));
+    }
+    hy_packagetable_free(table);
+    hy_packagelist_free(plist);
+
+    plist = hy_packagelist_create();
+    table = hy_packagetable_from_list(plist, columns, 2);
+    ck_assert_int_eq(hy_packagetable_count(table), 0);
+    hy_packagetable_free(table);
+    hy_packagelist_free(plist);
+    hy_query_free(q);
+}
+END_TEST
+
+Suite *
+packagetable_suite(void)
+{
+    Suite *s = suite_create("PackageTable");
+    TCase *tc = tcase_create("Core");
+    tcase_add_unchecked_fixture(tc, fixture_all, teardown);
+    tcase_add_test(tc, test_columns);
+    tcase_add_test(tc, test_from_list);
+    suite_add_tcase(s, tc);
+
+    return s;
+}
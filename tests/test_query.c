@@ -19,14 +19,20 @@
  */
 
 #include <check.h>
+#include <pthread.h>
+#include <string.h>
 
 // libsolv
+#include <solv/repodata.h>
 #include <solv/testcase.h>
 
 // hawkey
+#include "src/errno.h"
+#include "src/iutil.h"
 #include "src/query.h"
 #include "src/package.h"
-#include "src/packageset.h"
+#include "src/packageset_internal.h"
+#include "src/query_internal.h"
 #include "src/reldep.h"
 #include "src/sack_internal.h"
 #include "fixtures.h"
@@ -94,6 +100,46 @@ START_TEST(test_query_clone)
 }
 END_TEST
 
+START_TEST(test_query_clone_filter)
+{
+    HyQuery q = hy_query_create(test_globals.sack);
+
+    hy_query_filter(q, HY_PKG_NAME, HY_GLOB, "p*");
+    HyQuery clone = hy_query_clone(q);
+    hy_query_filter(clone, HY_PKG_NAME, HY_EQ, "penny");
+    ck_assert_int_eq(query_count_results(clone), 1);
+    hy_query_free(clone);
+    ck_assert_int_eq(size_and_free(q), 5);
+}
+END_TEST
+
+START_TEST(test_query_run_packed)
+{
+    HyQuery q = hy_query_create(test_globals.sack);
+    HyPackageList plist = hy_query_run(q);
+    HyPackageList packed = hy_query_run_packed(q);
+    const int count = hy_packagelist_count(plist);
+    HyPackage kept;
+
+    ck_assert_int_eq(hy_packagelist_count(packed), count);
+    for (int i = 0; i < count; ++i)
+	fail_unless(hy_package_identical(hy_packagelist_get(plist, i),
+					 hy_packagelist_get(packed, i)));
+    // a package survives its list
+    kept = hy_packagelist_get_clone(packed, count - 1);
+    hy_packagelist_free(packed);
+    fail_unless(hy_package_identical(kept, hy_packagelist_get(plist, count - 1)));
+    hy_package_free(kept);
+
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "no-such-package");
+    packed = hy_query_run_packed(q);
+    ck_assert_int_eq(hy_packagelist_count(packed), 0);
+    hy_packagelist_free(packed);
+    hy_packagelist_free(plist);
+    hy_query_free(q);
+}
+END_TEST
+
 START_TEST(test_query_empty)
 {
     HyQuery q = hy_query_create(test_globals.sack);
@@ -192,6 +238,122 @@ START_TEST(test_query_version)
 }
 END_TEST
 
+START_TEST(test_query_version_glob)
+{
+    HyQuery q = hy_query_create(test_globals.sack);
+    hy_query_filter(q, HY_PKG_VERSION, HY_GLOB, "5.*");
+    fail_unless(query_count_results(q) == 2);
+    hy_query_free(q);
+}
+END_TEST
+
+START_TEST(test_query_version_new_repo)
+{
+    HySack sack = test_globals.sack;
+    Pool *pool = sack_pool(sack);
+    HyQuery q = hy_query_create(sack);
+
+    hy_query_filter(q, HY_PKG_VERSION, HY_EQ, "4");
+    fail_unless(query_count_results(q) == 5);
+    hy_query_free(q);
+
+    const char *path = pool_tmpjoin(pool, test_globals.repo_dir,
+				    "main.repo", NULL);
+    fail_if(load_repo(pool, "main", path, 0));
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_VERSION, HY_EQ, "4");
+    fail_unless(query_count_results(q) == 9);
+    hy_query_free(q);
+}
+END_TEST
+
+START_TEST(test_query_requires_new_repo)
+{
+    HySack sack = test_globals.sack;
+    Pool *pool = sack_pool(sack);
+    HyQuery q = hy_query_create(sack);
+
+    hy_query_filter_requires(q, HY_EQ, "P-lib", NULL);
+    fail_unless(query_count_results(q) == 1);
+    hy_query_free(q);
+
+    const char *path = pool_tmpjoin(pool, test_globals.repo_dir,
+				    "main.repo", NULL);
+    fail_if(load_repo(pool, "main", path, 0));
+    q = hy_query_create(sack);
+    hy_query_filter_requires(q, HY_EQ, "P-lib", NULL);
+    fail_unless(query_count_results(q) == 2);
+    hy_query_free(q);
+}
+END_TEST
+
+/* the source package of 'p', in each of the forms
+   solvable_lookup_sourcepkg() builds */
+static void
+set_sourcepkg(Repodata *data, Id p, int form)
+{
+    switch (form % 5) {
+    case 0: // the package's own name and EVR, without the epoch
+	repodata_set_void(data, p, SOLVABLE_SOURCENAME);
+	repodata_set_void(data, p, SOLVABLE_SOURCEEVR);
+	repodata_set_id(data, p, SOLVABLE_SOURCEARCH, ARCH_SRC);
+	break;
+    case 1:
+	repodata_set_str(data, p, SOLVABLE_SOURCENAME, "origin");
+	repodata_set_str(data, p, SOLVABLE_SOURCEEVR, "2-3");
+	repodata_set_id(data, p, SOLVABLE_SOURCEARCH, ARCH_NOSRC);
+	break;
+    case 2: // without a source arch only the name
+	repodata_set_void(data, p, SOLVABLE_SOURCENAME);
+	break;
+    case 3: // without an EVR
+	repodata_set_str(data, p, SOLVABLE_SOURCENAME, "origin");
+	repodata_set_id(data, p, SOLVABLE_SOURCEARCH, ARCH_SRC);
+	break;
+    default: // no source package at all
+	break;
+    }
+}
+
+START_TEST(test_filter_sourcerpm_lookup)
+{
+    HySack sack = test_globals.sack;
+    Pool *pool = sack_pool(sack);
+    Repo *repo = pool->installed;
+    Repodata *data = repo_add_repodata(repo, 0);
+    Solvable *s;
+    Id p, p2;
+    int form = 0;
+
+    FOR_REPO_SOLVABLES(repo, p, s)
+	set_sourcepkg(data, p, form++);
+    repodata_internalize(data);
+
+    FOR_REPO_SOLVABLES(repo, p, s) {
+	const char *sourcepkg = solvable_lookup_sourcepkg(s);
+	if (sourcepkg == NULL)
+	    continue;
+	char *match = solv_strdup(sourcepkg);
+	HyQuery q = hy_query_create(sack);
+	hy_query_filter(q, HY_PKG_SOURCERPM, HY_EQ, match);
+	HyPackageSet pset = hy_query_run_set(q);
+	Map m;
+
+	packageset_to_map(pset, &m);
+	FOR_REPO_SOLVABLES(repo, p2, s) {
+	    sourcepkg = solvable_lookup_sourcepkg(s);
+	    int expected = sourcepkg != NULL && !strcmp(sourcepkg, match);
+	    ck_assert_int_eq(MAPTST(&m, p2) != 0, expected);
+	}
+	fail_unless(MAPTST(&m, p));
+	map_free(&m);
+	hy_packageset_free(pset);
+	hy_query_free(q);
+	solv_free(match);
+    }
+}
+END_TEST
+
 START_TEST(test_query_location)
 {
      HyQuery q = hy_query_create(test_globals.sack);
@@ -238,6 +400,21 @@ START_TEST(test_query_glob)
     hy_query_filter(q, HY_PKG_NAME, HY_GLOB, "pen*");
     fail_unless(query_count_results(q) == 2);
     hy_query_free(q);
+
+    q = hy_query_create(test_globals.sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_GLOB, "*-lib");
+    fail_unless(query_count_results(q) == 1);
+    hy_query_free(q);
+
+    q = hy_query_create(test_globals.sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_GLOB|HY_ICASE, "PEN*");
+    fail_unless(query_count_results(q) == 2);
+    hy_query_free(q);
+
+    q = hy_query_create(test_globals.sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_GLOB, "pen");
+    fail_unless(query_count_results(q) == 0);
+    hy_query_free(q);
 }
 END_TEST
 
@@ -517,6 +694,34 @@ START_TEST(test_filter_latest)
 }
 END_TEST
 
+START_TEST(test_filter_latest_all)
+{
+    HyQuery q = hy_query_create(test_globals.sack);
+    hy_query_filter_latest(q, 1);
+    HyPackageList plist = hy_query_run(q);
+    HyPackage pkg, pkg2;
+    int i, j;
+
+    // same names are not next to each other across the repos
+    fail_unless(hy_packagelist_count(plist) > 0);
+    FOR_PACKAGELIST(pkg, plist, i)
+	for (j = i + 1; j < hy_packagelist_count(plist); ++j) {
+	    pkg2 = hy_packagelist_get(plist, j);
+	    fail_if(!strcmp(hy_package_get_name(pkg),
+			    hy_package_get_name(pkg2)));
+	}
+    pkg = NULL;
+    FOR_PACKAGELIST(pkg2, plist, i)
+	if (!strcmp(hy_package_get_name(pkg2), "fool"))
+	    pkg = pkg2;
+    fail_if(pkg == NULL);
+    ck_assert_str_eq(hy_package_get_evr(pkg), "1-5");
+
+    hy_query_free(q);
+    hy_packagelist_free(plist);
+}
+END_TEST
+
 START_TEST(test_filter_latest2)
 {
     HyQuery q = hy_query_create(test_globals.sack);
@@ -549,6 +754,36 @@ START_TEST(test_filter_latest_archs)
 }
 END_TEST
 
+START_TEST(test_updown_as_what_updown)
+{
+    HySack sack = test_globals.sack;
+    Pool *pool = sack_pool(sack);
+    HyQuery q = hy_query_create(sack);
+    hy_query_filter_upgrades(q, 1);
+    HyPackageSet upgrades = hy_query_run_set(q);
+    hy_query_free(q);
+    q = hy_query_create(sack);
+    hy_query_filter_downgrades(q, 1);
+    HyPackageSet downgrades = hy_query_run_set(q);
+    hy_query_free(q);
+
+    Map up, down;
+    packageset_to_map(upgrades, &up);
+    packageset_to_map(downgrades, &down);
+    sack_make_provides_ready(sack);
+    for (Id p = 2; p < pool->nsolvables; ++p) {
+	if (pool_id2solvable(pool, p)->repo == pool->installed)
+	    continue;
+	ck_assert_int_eq(MAPTST(&up, p) != 0, what_upgrades(pool, p) > 0);
+	ck_assert_int_eq(MAPTST(&down, p) != 0, what_downgrades(pool, p) > 0);
+    }
+    map_free(&up);
+    map_free(&down);
+    hy_packageset_free(upgrades);
+    hy_packageset_free(downgrades);
+}
+END_TEST
+
 START_TEST(test_upgrade_already_installed)
 {
     /* if pkg is installed in two versions and the later is available in repos,
@@ -726,6 +961,222 @@ START_TEST(test_filter_reponames)
 }
 END_TEST
 
+static HyQuery
+planner_query(HySack sack, int flags)
+{
+    const char *repolist[] = {"main", NULL};
+    HyQuery q = hy_query_create_flags(sack, flags);
+
+    hy_query_filter(q, HY_PKG_ARCH, HY_NEQ, "noarch");
+    hy_query_filter_requires(q, HY_NEQ, "P-lib", NULL);
+    hy_query_filter(q, HY_PKG_NAME, HY_NOT | HY_GLOB, "penny*");
+    hy_query_filter(q, HY_PKG_VERSION, HY_GT, "2");
+    hy_query_filter_in(q, HY_PKG_REPONAME, HY_EQ, repolist);
+    return q;
+}
+
+START_TEST(test_query_appended_filter)
+{
+    HySack sack = test_globals.sack;
+    HyQuery q = hy_query_create(sack);
+    HyQuery fresh = hy_query_create(sack);
+    Map *result;
+
+    hy_query_filter(q, HY_PKG_NAME, HY_GLOB, "*a*");
+    query_count_results(q);
+    result = q->result;
+    hy_query_filter(q, HY_PKG_ARCH, HY_NEQ, "noarch");
+    fail_if(query_evaluated(q));
+    hy_query_filter(fresh, HY_PKG_ARCH, HY_NEQ, "noarch");
+    hy_query_filter(fresh, HY_PKG_NAME, HY_GLOB, "*a*");
+    ck_assert_int_eq(query_count_results(q), query_count_results(fresh));
+    fail_unless(q->result == result);
+    fail_if(memcmp(q->result->map, fresh->result->map, q->result->size));
+
+    // the latest are only known after all the filters
+    hy_query_filter_latest(q, 1);
+    hy_query_filter_latest(fresh, 1);
+    query_count_results(q);
+    result = q->result;
+    hy_query_filter(q, HY_PKG_EVR, HY_LT, "5.0-0");
+    hy_query_filter(fresh, HY_PKG_EVR, HY_LT, "5.0-0");
+    ck_assert_int_eq(query_count_results(q), query_count_results(fresh));
+    fail_if(memcmp(q->result->map, fresh->result->map, q->result->size));
+    hy_query_free(q);
+    hy_query_free(fresh);
+}
+END_TEST
+
+START_TEST(test_query_planner)
+{
+    HySack sack = test_globals.sack;
+    HyQuery q = planner_query(sack, 0);
+    HyQuery q_unplanned = planner_query(sack, HY_NO_OPTIMIZE);
+    HyPackageSet pset = hy_query_run_set(q);
+    HyPackageSet pset_unplanned = hy_query_run_set(q_unplanned);
+
+    fail_unless(hy_packageset_count(pset) == 4);
+    fail_unless(hy_packageset_count(pset_unplanned) == 4);
+    for (int i = 0; i < hy_packageset_count(pset); ++i) {
+	HyPackage pkg = hy_packageset_get_clone(pset, i);
+	fail_unless(hy_packageset_has(pset_unplanned, pkg));
+	hy_package_free(pkg);
+    }
+
+    // a filter matching nothing ends the evaluation early:
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "no-such-package");
+    fail_unless(query_count_results(q) == 0);
+
+    hy_packageset_free(pset);
+    hy_packageset_free(pset_unplanned);
+    hy_query_free(q);
+    hy_query_free(q_unplanned);
+}
+END_TEST
+
+#define FROZEN_NQUERIES 10
+#define FROZEN_NTHREADS 4
+
+static int
+frozen_query_count(HySack sack, int which)
+{
+    HyQuery q = hy_query_create(sack);
+
+    switch (which) {
+    case 0:
+	hy_query_filter(q, HY_PKG_NAME, HY_GLOB, "p*");
+	break;
+    case 1:
+	hy_query_filter_provides(q, HY_GT, "P-lib", "1-1");
+	break;
+    case 2:
+	hy_query_filter_requires(q, HY_EQ, "P-lib", NULL);
+	break;
+    case 3:
+	hy_query_filter(q, HY_PKG_EVR, HY_GT, "2.5-0");
+	break;
+    case 4:
+	hy_query_filter(q, HY_PKG_NEVRA, HY_GLOB, "*.x86_64");
+	break;
+    case 5:
+	hy_query_filter(q, HY_PKG_VERSION, HY_LT, "4.8");
+	break;
+    case 6:
+	hy_query_filter(q, HY_PKG_RELEASE, HY_EQ, "1");
+	break;
+    case 7:
+	hy_query_filter_latest_per_arch(q, 1);
+	break;
+    case 8:
+	hy_query_filter_upgrades(q, 1);
+	break;
+    case 9:
+	hy_query_filter(q, HY_PKG_SUMMARY, HY_SUBSTR, "in my");
+	break;
+    }
+    return size_and_free(q);
+}
+
+struct _FrozenRun {
+    HySack sack;
+    const int *expected;
+    int mismatches;
+};
+
+static void *
+frozen_worker(void *arg)
+{
+    struct _FrozenRun *run = arg;
+
+    for (int round = 0; round < 50; ++round)
+	for (int i = 0; i < FROZEN_NQUERIES; ++i)
+	    if (frozen_query_count(run->sack, i) != run->expected[i])
+		run->mismatches++;
+    return NULL;
+}
+
+static HyPackageSet
+scanned_query(HySack sack, int i)
+{
+    HyQuery q = hy_query_create(sack);
+
+    switch (i) {
+    case 0:
+	hy_query_filter_num(q, HY_PKG_EPOCH, HY_GT, 0);
+	break;
+    case 1:
+	hy_query_filter(q, HY_PKG_EVR, HY_GT, "4-0");
+	break;
+    case 2:
+	hy_query_filter(q, HY_PKG_VERSION, HY_LT, "5");
+	break;
+    case 3:
+	hy_query_filter(q, HY_PKG_RELEASE, HY_EQ, "1");
+	break;
+    case 4:
+	hy_query_filter_requires(q, HY_EQ, "P-lib", NULL);
+	break;
+    default:
+	hy_query_filter(q, HY_PKG_SOURCERPM, HY_EQ, "jay-5.0-0.src.rpm");
+	break;
+    }
+    HyPackageSet pset = hy_query_run_set(q);
+    hy_query_free(q);
+    return pset;
+}
+
+START_TEST(test_query_threads)
+{
+    HySack sack = test_globals.sack;
+    HyPackageSet serial = scanned_query(sack, _i);
+
+    hy_sack_set_query_threads(sack, 4);
+    sack->scan_chunk = 8;
+    HyPackageSet threaded = scanned_query(sack, _i);
+    fail_if(sack->workers == NULL);
+    hy_sack_set_query_threads(sack, 1);
+    sack->scan_chunk = SCAN_CHUNK;
+
+    Map ms, mt;
+    packageset_to_map(serial, &ms);
+    packageset_to_map(threaded, &mt);
+    ck_assert_int_eq(hy_packageset_count(threaded),
+		     hy_packageset_count(serial));
+    for (Id p = 0; p < sack_pool(sack)->nsolvables; ++p)
+	ck_assert_int_eq(MAPTST(&mt, p) != 0, MAPTST(&ms, p) != 0);
+    map_free(&ms);
+    map_free(&mt);
+    hy_packageset_free(serial);
+    hy_packageset_free(threaded);
+}
+END_TEST
+
+START_TEST(test_query_frozen)
+{
+    HySack sack = test_globals.sack;
+    struct _FrozenRun runs[FROZEN_NTHREADS];
+    pthread_t threads[FROZEN_NTHREADS];
+    int expected[FROZEN_NQUERIES];
+
+    for (int i = 0; i < FROZEN_NQUERIES; ++i)
+	expected[i] = frozen_query_count(sack, i);
+    fail_if(hy_sack_freeze(sack));
+    fail_unless(sack_frozen(sack));
+
+    for (int i = 0; i < FROZEN_NTHREADS; ++i) {
+	runs[i].sack = sack;
+	runs[i].expected = expected;
+	runs[i].mismatches = 0;
+	fail_if(pthread_create(threads + i, NULL, frozen_worker, runs + i));
+    }
+    for (int i = 0; i < FROZEN_NTHREADS; ++i) {
+	pthread_join(threads[i], NULL);
+	ck_assert_int_eq(runs[i].mismatches, 0);
+    }
+    fail_unless(sack_frozen(sack));
+}
+END_TEST
+
 START_TEST(test_excluded)
 {
     HySack sack = test_globals.sack;
@@ -772,6 +1223,141 @@ START_TEST(test_disabled_repo)
 }
 END_TEST
 
+static HyPackageSet
+named_set(HySack sack, const char *name)
+{
+    HyQuery q = hy_query_create_flags(sack, HY_IGNORE_EXCLUDES);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, name);
+    HyPackageSet pset = hy_query_run_set(q);
+    hy_query_free(q);
+    return pset;
+}
+
+/* the considered map was updated in place and matches a full recompute */
+static void
+assert_considered_incremental(HySack sack)
+{
+    Map *considered = sack_pool(sack)->considered;
+    Map incremental;
+
+    fail_unless(sack->considered_uptodate);
+    map_init_clone(&incremental, considered);
+    sack->considered_uptodate = 0;
+    sack_recompute_considered(sack);
+    ck_assert_int_eq(incremental.size, considered->size);
+    fail_if(memcmp(incremental.map, considered->map, considered->size));
+    map_free(&incremental);
+}
+
+START_TEST(test_excludes_incremental)
+{
+    HySack sack = test_globals.sack;
+    HyPackageSet pset = named_set(sack, "jay");
+    HyQuery q;
+
+    hy_sack_add_excludes(sack, pset);
+    hy_packageset_free(pset);
+    fail_if(hy_sack_freeze(sack));
+
+    pset = named_set(sack, "penny");
+    hy_sack_add_excludes(sack, pset);
+    hy_packageset_free(pset);
+    fail_unless(sack_frozen(sack));
+    assert_considered_incremental(sack);
+
+    hy_sack_repo_enabled(sack, "main", 0);
+    fail_if(sack_frozen(sack));
+    assert_considered_incremental(sack);
+    hy_sack_repo_enabled(sack, "main", 1);
+    assert_considered_incremental(sack);
+
+    pset = named_set(sack, "penny");
+    hy_sack_add_includes(sack, pset);
+    hy_packageset_free(pset);
+    assert_considered_incremental(sack);
+    pset = named_set(sack, "fool");
+    hy_sack_add_includes(sack, pset);
+    hy_packageset_free(pset);
+    assert_considered_incremental(sack);
+
+    q = hy_query_create(sack);
+    ck_assert_int_eq(size_and_free(q), 2);
+}
+END_TEST
+
+START_TEST(test_excludes_edit)
+{
+    HySack sack = test_globals.sack;
+    HyPackageSet pset = named_set(sack, "jay");
+    HyQuery q;
+
+    hy_sack_begin_edit(sack);
+    hy_sack_add_excludes(sack, pset);
+    hy_packageset_free(pset);
+    hy_sack_begin_edit(sack);
+    hy_sack_repo_enabled(sack, "main", 0);
+    fail_if(hy_sack_end_edit(sack));
+    fail_if(sack->considered_uptodate);
+    fail_if(hy_sack_end_edit(sack));
+    fail_unless(sack->considered_uptodate);
+    ck_assert_int_eq(hy_sack_end_edit(sack), HY_E_OP);
+
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "jay");
+    ck_assert_int_eq(size_and_free(q), 0);
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "penny");
+    ck_assert_int_eq(size_and_free(q), 1);
+}
+END_TEST
+
+START_TEST(test_query_cache)
+{
+    HySack sack = test_globals.sack;
+    HyQuery q;
+
+    hy_sack_set_query_cache_size(sack, 2);
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "jay");
+    hy_query_filter(q, HY_PKG_ARCH, HY_EQ, "x86_64");
+    ck_assert_int_eq(size_and_free(q), 5);
+    ck_assert_int_eq(hy_sack_get_query_cache_misses(sack), 1);
+
+    // the same filters in another order
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_ARCH, HY_EQ, "x86_64");
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "jay");
+    ck_assert_int_eq(size_and_free(q), 5);
+    ck_assert_int_eq(hy_sack_get_query_cache_hits(sack), 1);
+
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "jay");
+    hy_query_filter_latest_per_arch(q, 1);
+    ck_assert_int_eq(size_and_free(q), 1);
+    ck_assert_int_eq(hy_sack_get_query_cache_misses(sack), 2);
+
+    hy_sack_repo_enabled(sack, "main", 0);
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "jay");
+    hy_query_filter(q, HY_PKG_ARCH, HY_EQ, "x86_64");
+    ck_assert_int_eq(size_and_free(q), 2);
+    hy_sack_repo_enabled(sack, "main", 1);
+
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "jay");
+    HyPackageSet pset = hy_query_run_set(q);
+    hy_query_free(q);
+    hy_sack_add_excludes(sack, pset);
+    hy_packageset_free(pset);
+    q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "jay");
+    hy_query_filter(q, HY_PKG_ARCH, HY_EQ, "x86_64");
+    ck_assert_int_eq(size_and_free(q), 0);
+    ck_assert_int_eq(hy_sack_get_query_cache_hits(sack), 1);
+    ck_assert_int_eq(hy_sack_get_query_cache_misses(sack), 5);
+}
+END_TEST
+
 START_TEST(test_query_nevra_glob)
 {
     HySack sack = test_globals.sack;
@@ -844,12 +1430,15 @@ query_suite(void)
     tcase_add_test(tc, test_query_run_set_sanity);
     tcase_add_test(tc, test_query_clear);
     tcase_add_test(tc, test_query_clone);
+    tcase_add_test(tc, test_query_clone_filter);
+    tcase_add_test(tc, test_query_run_packed);
     tcase_add_test(tc, test_query_empty);
     tcase_add_test(tc, test_query_repo);
     tcase_add_test(tc, test_query_name);
     tcase_add_test(tc, test_query_evr);
     tcase_add_test(tc, test_query_epoch);
     tcase_add_test(tc, test_query_version);
+    tcase_add_test(tc, test_query_version_glob);
     tcase_add_test(tc, test_query_release);
     tcase_add_test(tc, test_query_glob);
     tcase_add_test(tc, test_query_case);
@@ -864,12 +1453,20 @@ query_suite(void)
     tcase_add_test(tc, test_query_multiple_flags);
     suite_add_tcase(s, tc);
 
+    tc = tcase_create("ModifiesSackState");
+    tcase_add_checked_fixture(tc, fixture_system_only, teardown);
+    tcase_add_test(tc, test_query_version_new_repo);
+    tcase_add_test(tc, test_query_requires_new_repo);
+    tcase_add_test(tc, test_filter_sourcerpm_lookup);
+    suite_add_tcase(s, tc);
+
     tc = tcase_create("Updates");
     tcase_add_unchecked_fixture(tc, fixture_with_updates, teardown);
     tcase_add_test(tc, test_upgrades_sanity);
     tcase_add_test(tc, test_upgrades);
     tcase_add_test(tc, test_upgradable);
     tcase_add_test(tc, test_filter_latest);
+    tcase_add_test(tc, test_filter_latest_all);
     tcase_add_test(tc, test_query_provides_in);
     tcase_add_test(tc, test_query_provides_in_not_found);
     suite_add_tcase(s, tc);
@@ -890,8 +1487,13 @@ query_suite(void)
     tcase_add_unchecked_fixture(tc, fixture_all, teardown);
     tcase_add_test(tc, test_filter_latest2);
     tcase_add_test(tc, test_filter_latest_archs);
+    tcase_add_test(tc, test_updown_as_what_updown);
     tcase_add_test(tc, test_filter_obsoletes);
     tcase_add_test(tc, test_filter_reponames);
+    tcase_add_test(tc, test_query_appended_filter);
+    tcase_add_test(tc, test_query_planner);
+    tcase_add_loop_test(tc, test_query_threads, 0, 6);
+    tcase_add_test(tc, test_query_frozen);
     suite_add_tcase(s, tc);
 
     tc = tcase_create("Filelists etc.");
@@ -907,6 +1509,9 @@ query_suite(void)
     tcase_add_checked_fixture(tc, fixture_reset, NULL);
     tcase_add_test(tc, test_excluded);
     tcase_add_test(tc, test_disabled_repo);
+    tcase_add_test(tc, test_query_cache);
+    tcase_add_test(tc, test_excludes_incremental);
+    tcase_add_test(tc, test_excludes_edit);
     suite_add_tcase(s, tc);
 
     return s;
@@ -30,6 +30,7 @@
 // hawkey
 #include "src/errno.h"
 #include "src/package_internal.h"
+#include "src/query.h"
 #include "src/repo_internal.h"
 #include "src/sack_internal.h"
 #include "src/util.h"
@@ -106,6 +107,22 @@ START_TEST(test_load_yum_repo_err)
 }
 END_TEST
 
+START_TEST(test_load_yum_repos_err)
+{
+    HySack sack = hy_sack_create(test_globals.tmpdir, NULL, NULL, NULL,
+				 HY_MAKE_CACHE_DIR);
+    HyRepo repos[2] = {hy_repo_create("crabalocker"),
+		       hy_repo_create("crabalocker2")};
+    for (int i = 0; i < 2; ++i)
+	hy_repo_set_string(repos[i], HY_REPO_MD_FN, "/non/existing");
+    fail_unless(hy_sack_load_yum_repos(sack, repos, 2, 0, 2) == HY_E_FAILED);
+    fail_unless(hy_get_errno() == HY_E_IO);
+    hy_repo_free(repos[0]);
+    hy_repo_free(repos[1]);
+    hy_sack_free(sack);
+}
+END_TEST
+
 START_TEST(test_yum_repo_written)
 {
     HySack sack = hy_sack_create(test_globals.tmpdir, NULL, NULL, NULL,
@@ -237,6 +254,49 @@ START_TEST(test_presto_from_cache)
 }
 END_TEST
 
+START_TEST(test_load_yum_repos)
+{
+    HySack sack = hy_sack_create(test_globals.tmpdir, NULL, NULL, NULL,
+				 HY_MAKE_CACHE_DIR);
+    Pool *pool = sack_pool(sack);
+    const char *repo_path = pool_tmpjoin(pool, test_globals.repo_dir,
+					 YUM_DIR_SUFFIX, NULL);
+    HyRepo repos[2] = {glob_for_repofiles(pool, "test_batch_1", repo_path),
+		       glob_for_repofiles(pool, "test_batch_2", repo_path)};
+
+    fail_if(hy_sack_load_yum_repos(sack, repos, 2,
+				   HY_BUILD_CACHE | HY_LOAD_FILELISTS |
+				   HY_LOAD_PRESTO, 2));
+    fail_unless(hy_sack_count(sack) == 2 * TEST_EXPECT_YUM_NSOLVABLES);
+    for (int i = 0; i < 2; ++i) {
+	fail_unless(repos[i]->state_main == _HY_WRITTEN);
+	fail_unless(repos[i]->state_filelists == _HY_WRITTEN);
+	fail_unless(repos[i]->state_presto == _HY_WRITTEN);
+    }
+    hy_sack_free(sack);
+}
+END_TEST
+
+START_TEST(test_yum_repo_freeze)
+{
+    HySack sack = hy_sack_create(test_globals.tmpdir, NULL, NULL, NULL,
+				 HY_MAKE_CACHE_DIR);
+    setup_yum_sack(sack, YUM_REPO_NAME);
+
+    fail_if(hy_sack_freeze(sack));
+    fail_unless(sack_frozen(sack));
+
+    HyQuery q = hy_query_create(sack);
+    hy_query_filter(q, HY_PKG_NAME, HY_EQ, "tour");
+    HyPackageList plist = hy_query_run(q);
+    ck_assert_int_eq(hy_packagelist_count(plist), 1);
+    hy_packagelist_free(plist);
+    hy_query_free(q);
+    fail_unless(sack_frozen(sack));
+    hy_sack_free(sack);
+}
+END_TEST
+
 START_TEST(test_sack_knows)
 {
     HySack sack = test_globals.sack;
@@ -277,6 +337,7 @@ sack_suite(void)
     tcase_add_test(tc, test_list_arches);
     tcase_add_test(tc, test_load_yum_repo_err);
     tcase_add_test(tc, test_yum_repo_written);
+    tcase_add_test(tc, test_load_yum_repos_err);
     suite_add_tcase(s, tc);
 
     tc = tcase_create("Repos");
@@ -290,6 +351,8 @@ sack_suite(void)
     tcase_add_test(tc, test_filelist_from_cache);
     tcase_add_test(tc, test_presto);
     tcase_add_test(tc, test_presto_from_cache);
+    tcase_add_test(tc, test_load_yum_repos);
+    tcase_add_test(tc, test_yum_repo_freeze);
     suite_add_tcase(s, tc);
 
     tc = tcase_create("SackKnows");
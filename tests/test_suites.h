@@ -31,6 +31,7 @@ Suite *iutil_suite(void);
 Suite *package_suite(void);
 Suite *packagelist_suite(void);
 Suite *packageset_suite(void);
+Suite *packagetable_suite(void);
 Suite *query_suite(void);
 Suite *reldep_suite(void);
 Suite *repo_suite(void);